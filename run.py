@@ -18,6 +18,8 @@ Note there are some databases and sizes commented by default just to minimize th
 """
 
 db_names = [
+    # "null",  # Harness ceiling, run it first to compare others against
+    # "echo",
     # "ustore",
     # "rocksdb",
     "leveldb",
@@ -150,6 +152,13 @@ def run(
         db_name, size, drop_caches, transactional, storage_disk_paths, threads_count
     )
 
+    ceiling_results_file_path = get_results_file_path(
+        "null", size, drop_caches, transactional, storage_disk_paths, threads_count
+    )
+    ceiling_flag = ""
+    if db_name != "null" and os.path.exists(ceiling_results_file_path):
+        ceiling_flag = f'-cr "{ceiling_results_file_path}"'
+
     transactional_flag = "-t" if transactional else ""
     filter = ",".join(workload_names)
     db_storage_dir_paths = ",".join(db_storage_dir_paths)
@@ -163,7 +172,7 @@ def run(
         if not os.path.exists(runner):
             raise Exception("First, please build the runner: `build_release.sh`")
 
-    command = f'{runner} -db {db_name} {transactional_flag} -cfg "{db_config_file_path}" -wl "{workloads_file_path}" -md "{db_main_dir_path}" -sd "{db_storage_dir_paths}" -res "{results_file_path}" -th {threads_count} -fl {filter} -ri {run_index} -rc {runs_count}'
+    command = f'{runner} -db {db_name} {transactional_flag} -cfg "{db_config_file_path}" -wl "{workloads_file_path}" -md "{db_main_dir_path}" -sd "{db_storage_dir_paths}" -res "{results_file_path}" -th {threads_count} -fl {filter} -ri {run_index} -rc {runs_count} {ceiling_flag}'
     print(command)
     process = pexpect.spawn(command)
     process.interact()
@@ -1,5 +1,9 @@
+#include <array>
 #include <atomic>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -26,6 +30,18 @@
 #include "src/core/printable.hpp"
 #include "src/core/reporter.hpp"
 #include "src/core/threads_fence.hpp"
+#include "src/core/histogram.hpp"
+#include "src/core/thread_stats.hpp"
+#include "src/core/sampler.hpp"
+#include "src/core/progress.hpp"
+#include "src/core/pacer.hpp"
+#include "src/core/perf_counters.hpp"
+#include "src/core/io_profiler.hpp"
+#include "src/core/thread_roles.hpp"
+#include "src/core/allocations.hpp"
+#include "src/core/placement.hpp"
+#include "src/core/trace.hpp"
+#include "src/core/slo.hpp"
 
 namespace bm = benchmark;
 using namespace ucsb;
@@ -45,9 +61,48 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
         .default_value(std::string(""))
         .help("Database storage directory paths");
     program.add_argument("-th", "--threads").default_value(std::string("1")).help("Threads count");
+    program.add_argument("-ts", "--threads-sweep")
+        .default_value(std::string(""))
+        .help("Thread counts to run every workload with, keeping the DB open, like \"1,2,4,8\"");
     program.add_argument("-fl", "--filter").default_value(std::string("")).help("Workloads filter");
     program.add_argument("-ri", "--run-index").default_value(std::string("0")).help("Run index in sequence");
     program.add_argument("-rc", "--runs-count").default_value(std::string("1")).help("Total runs count");
+    program.add_argument("-cr", "--ceiling-results")
+        .default_value(std::string(""))
+        .help("Results file path of the null DB, to compare throughputs with");
+    program.add_argument("-pi", "--profile-interval")
+        .default_value(std::string("100"))
+        .help("CPU and memory profiling interval in milliseconds");
+    program.add_argument("-si", "--sample-interval")
+        .default_value(std::string("1000"))
+        .help("Time series sampling interval in milliseconds, 0 to disable");
+
+    program.add_argument("-pg", "--pregenerate")
+        .default_value(std::string("0"))
+        .help("Pre-generate operations per thread in chunks of this size, 0 to generate them inline");
+    program.add_argument("-pc", "--perf-counters")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Count hardware events with perf_event_open (Linux only)");
+    program.add_argument("-pin", "--pin-threads")
+        .default_value(std::string(""))
+        .help("Pin workers to CPUs: \"cores\" for one per physical core, or a CPU list, like \"0-3,8\"");
+    program.add_argument("-numa", "--numa-bind")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Bind memory of every worker to the NUMA node of its CPU, requires pinning");
+    program.add_argument("-hp", "--huge-pages")
+        .default_value(std::string("none"))
+        .help("Back worker buffers with huge pages: none, thp or hugetlb");
+    program.add_argument("-qd", "--queue-depth")
+        .default_value(std::string("1"))
+        .help("Operations in flight per thread, submitted through the asynchronous interface if above 1");
+    program.add_argument("-seed", "--seed")
+        .default_value(std::string(""))
+        .help("Seed of all random generators, a random one by default, recorded in the results");
+    program.add_argument("-rt", "--record-trace")
+        .default_value(std::string(""))
+        .help("Directory to record traces of operations into, one per workload");
 
     program.parse_known_args(argc, argv);
 
@@ -56,10 +111,29 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
     settings.db_config_file_path = program.get("config-path");
     settings.workloads_file_path = program.get("workload-path");
     settings.results_file_path = program.get("results-path");
+    settings.ceiling_results_file_path = program.get("ceiling-results");
     settings.threads_count = std::stoi(program.get("threads"));
+    for (auto const& count : split(program.get("threads-sweep"), ','))
+        if (!count.empty())
+            settings.threads_sweep.push_back(std::stoull(count));
+    std::sort(settings.threads_sweep.begin(), settings.threads_sweep.end());
+    settings.threads_sweep.erase(std::unique(settings.threads_sweep.begin(), settings.threads_sweep.end()),
+                                 settings.threads_sweep.end());
     settings.workload_filter = program.get("filter");
     settings.run_idx = std::stoi(program.get("run-index"));
     settings.runs_count = std::stoi(program.get("runs-count"));
+    settings.profile_interval = std::stoi(program.get("profile-interval"));
+    settings.sample_interval = std::stoi(program.get("sample-interval"));
+    settings.perf_counters = program.get<bool>("perf-counters");
+    settings.pregenerate_chunk = std::stoull(program.get("pregenerate"));
+    settings.pin_threads = program.get("pin-threads");
+    settings.numa_bind = program.get<bool>("numa-bind");
+    settings.huge_pages = parse_huge_pages(program.get("huge-pages"));
+    settings.queue_depth = std::stoull(program.get("queue-depth"));
+    settings.trace_dir_path = program.get("record-trace");
+    std::string seed = program.get("seed");
+    std::random_device device;
+    settings.seed = seed.empty() ? (uint64_t(device()) << 32) | device() : std::stoull(seed);
 
     // Resolve paths
     auto path = program.get("main-dir");
@@ -77,10 +151,21 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
     }
 
     // Check arguments
+    if (settings.profile_interval == 0) {
+        fmt::print("Zero profiling interval specified\n");
+        exit(1);
+    }
     if (settings.threads_count == 0) {
         fmt::print("Zero threads count specified\n");
         exit(1);
     }
+    if (!settings.threads_sweep.empty()) {
+        if (settings.threads_sweep.front() == 0) {
+            fmt::print("Zero threads count specified in the sweep\n");
+            exit(1);
+        }
+        settings.threads_count = settings.threads_sweep.back();
+    }
     if (settings.runs_count == 0) {
         fmt::print("Zero total runs count specified\n");
         exit(1);
@@ -89,6 +174,14 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
         fmt::print("Invalid run index specified\n");
         exit(1);
     }
+    if (settings.queue_depth == 0) {
+        fmt::print("Zero queue depth specified\n");
+        exit(1);
+    }
+    if (settings.numa_bind && settings.pin_threads.empty()) {
+        fmt::print("NUMA binding requires pinning threads\n");
+        exit(1);
+    }
 }
 
 std::string build_title(settings_t const& settings, workloads_t const& workloads, std::string const& db_info) {
@@ -109,7 +202,10 @@ std::string build_title(settings_t const& settings, workloads_t const& workloads
         infos.push_back(fmt::format("Workload size: {}", printable_bytes_t {db_size}));
     }
 
-    infos.push_back(fmt::format("Threads: {}", settings.threads_count));
+    if (settings.threads_sweep.empty())
+        infos.push_back(fmt::format("Threads: {}", settings.threads_count));
+    else
+        infos.push_back(fmt::format("Threads: {}", fmt::join(settings.threads_sweep, ",")));
     infos.push_back(fmt::format("Disks: {}", std::max(size_t(1), settings.db_storage_dir_paths.size())));
 
     return fmt::format("{}", fmt::join(infos, " | "));
@@ -125,7 +221,37 @@ inline void register_benchmark(std::string const& name, size_t threads_count, fu
         ->Iterations(1);
 }
 
-void run(int argc, char* argv[], std::string const& title, size_t idx, size_t count, std::string const& results_path) {
+/**
+ * @brief Records the machine topology and the placement of workers in the context of results.
+ */
+void add_placement_context(settings_t const& settings, threads_placement_t const& placement) {
+
+    auto const& topology = placement.topology();
+    bm::AddCustomContext("topology",
+                         fmt::format("{} CPUs, {} cores, {} sockets, {} NUMA nodes",
+                                     topology.cpus().size(),
+                                     topology.cores_count(),
+                                     topology.sockets_count(),
+                                     topology.nodes_count()));
+
+    std::vector<size_t> cpus;
+    std::vector<size_t> nodes;
+    for (size_t thread_idx = 0; thread_idx != placement.threads_count(); ++thread_idx) {
+        cpus.push_back(placement.cpu(thread_idx));
+        nodes.push_back(placement.node(thread_idx));
+    }
+    bm::AddCustomContext("threads_cpus", placement.pinned() ? fmt::format("{}", fmt::join(cpus, ",")) : "any");
+    bm::AddCustomContext("threads_nodes", placement.numa_bound() ? fmt::format("{}", fmt::join(nodes, ",")) : "any");
+    bm::AddCustomContext("huge_pages", huge_pages_name(settings.huge_pages));
+}
+
+void run(int argc,
+         char* argv[],
+         std::string const& title,
+         size_t idx,
+         size_t count,
+         std::string const& results_path,
+         std::string const& ceiling_results_path) {
     (void)argc;
 
     int bm_argc = 4;
@@ -158,7 +284,7 @@ void run(int argc, char* argv[], std::string const& title, size_t idx, size_t co
         else if (idx < count)
             sections = console_reporter_t::sections_t(console_reporter_t::result_k);
     }
-    console_reporter_t console(title, sections);
+    console_reporter_t console(title, sections, file_reporter_t::load_throughputs(ceiling_results_path));
     bm::RunSpecifiedBenchmarks(&console);
 }
 
@@ -168,6 +294,15 @@ void validate_workload(workload_t const& workload, [[maybe_unused]] size_t threa
     assert(!workload.name.empty());
     assert(workload.db_records_count > 0);
     assert(workload.db_operations_count > 0);
+    assert(workload.target_ops_per_second >= 0);
+    assert(workload.duration_s >= 0);
+    assert(workload.warmup_s >= 0);
+    if (!workload.groups.empty()) {
+        assert(workload.phases.empty());
+        for (auto const& group : workload.groups)
+            validate_workload(group, group.threads_count);
+        return;
+    }
 
     float proportion = 0;
     proportion += workload.upsert_proportion;
@@ -180,9 +315,12 @@ void validate_workload(workload_t const& workload, [[maybe_unused]] size_t threa
     proportion += workload.bulk_load_proportion;
     proportion += workload.range_select_proportion;
     proportion += workload.scan_proportion;
-    assert(proportion > 0.0 && proportion <= 1.0);
+    // Note: Replayed traces define operations themselves
+    assert(workload.key_dist == distribution_kind_t::replay_k || (proportion > 0.0 && proportion <= 1.0));
+    assert(workload.key_dist != distribution_kind_t::replay_k || !workload.trace_path.empty());
 
     assert(workload.value_length > 0);
+    assert(workload.value_compression_ratio > 0 && workload.value_compression_ratio <= 1);
 
     assert(workload.key_dist != distribution_kind_t::unknown_k);
 
@@ -205,6 +343,18 @@ void validate_workload(workload_t const& workload, [[maybe_unused]] size_t threa
            (workload.range_select_proportion > 0.0 && workload.range_select_min_length > 0));
     assert(workload.range_select_min_length <= workload.range_select_max_length);
     assert(workload.range_select_max_length <= workload.db_records_count / threads_count);
+
+    assert(workload.hot_set_offset >= 0 && workload.hot_set_offset < 1);
+    assert(workload.zipfian_theta > 0);
+    assert(workload.hotspot_keys_fraction > 0 && workload.hotspot_keys_fraction <= 1);
+    assert(workload.hotspot_operations_fraction >= 0 && workload.hotspot_operations_fraction <= 1);
+    assert(workload.exponential_percentile > 0 && workload.exponential_percentile < 100);
+    assert(workload.exponential_fraction > 0);
+    assert(workload.sequential_stride > 0);
+    for (auto const& phase : workload.phases) {
+        assert(phase.duration_s > 0);
+        validate_workload(phase, threads_count);
+    }
 }
 
 workloads_t filter_workloads(workloads_t const& workloads, std::string const& filter) {
@@ -226,12 +376,26 @@ workloads_t filter_workloads(workloads_t const& workloads, std::string const& fi
 
 std::vector<workload_t> split_workload_into_threads(workload_t const& workload, size_t threads_count) {
     std::vector<workload_t> workloads;
+    if (!workload.groups.empty()) {
+        for (auto const& group : workload.groups) {
+            auto group_workloads = split_workload_into_threads(group, group.threads_count);
+            for (auto& thread_workload : group_workloads) {
+                // Note: Every thread knows all groups, to report them
+                thread_workload.name = workload.name;
+                thread_workload.groups = workload.groups;
+                workloads.push_back(thread_workload);
+            }
+        }
+        return workloads;
+    }
     workloads.reserve(threads_count);
 
     auto records_count_per_thread = workload.db_records_count / threads_count;
     auto operations_count_per_thread = workload.db_operations_count / threads_count;
     auto leftover_records_count = workload.db_records_count % threads_count;
     auto leftover_operations_count = workload.db_operations_count % threads_count;
+    auto warmup_operations_per_thread = workload.db_warmup_operations / threads_count;
+    auto leftover_warmup_operations = workload.db_warmup_operations % threads_count;
 
     auto start_key = workload.start_key;
     for (size_t idx = 0; idx < threads_count; ++idx) {
@@ -239,20 +403,21 @@ std::vector<workload_t> split_workload_into_threads(workload_t const& workload,
         thread_workload.records_count = records_count_per_thread + bool(leftover_records_count);
         thread_workload.operations_count = operations_count_per_thread + bool(leftover_operations_count);
         thread_workload.operations_count = std::max(size_t(1), thread_workload.operations_count);
+        thread_workload.warmup_operations = warmup_operations_per_thread + bool(leftover_warmup_operations);
         thread_workload.start_key = start_key;
+        thread_workload.trace_partition = idx;
+        thread_workload.trace_partitions = threads_count;
+        thread_workload.threads_count = threads_count;
         workloads.push_back(thread_workload);
 
         leftover_records_count -= bool(leftover_records_count);
         leftover_operations_count -= bool(leftover_operations_count);
+        leftover_warmup_operations -= bool(leftover_warmup_operations);
 
-        if (workload.upsert_proportion == 1.0 || workload.batch_upsert_proportion == 1.0 ||
-            workload.bulk_load_proportion == 1.0) {
-            size_t new_records_count =
-                bool(workload.upsert_proportion) * thread_workload.operations_count +
-                bool(workload.bulk_load_proportion) * thread_workload.operations_count * workload.bulk_load_max_length +
-                bool(workload.batch_upsert_proportion) * thread_workload.operations_count *
-                    workload.batch_upsert_max_length;
-            start_key += new_records_count;
+        if (upserts_only(workload)) {
+            // Note: Warm-up upserts new keys as well
+            size_t operations_count = thread_workload.warmup_operations + thread_workload.operations_count;
+            start_key += new_records_count(workload, operations_count);
         }
         else
             start_key += workloads.back().records_count;
@@ -270,8 +435,8 @@ db_hints_t make_hints(settings_t const& settings, workloads_t const& workloads)
     return hints;
 }
 
-operation_chooser_ptr_t create_operation_chooser(workload_t const& workload) {
-    operation_chooser_ptr_t chooser = std::make_unique<operation_chooser_t>();
+operation_chooser_ptr_t create_operation_chooser(workload_t const& workload, core::random_streams_t& streams) {
+    operation_chooser_ptr_t chooser = std::make_unique<operation_chooser_t>(streams.next());
     chooser->add(operation_kind_t::upsert_k, workload.upsert_proportion);
     chooser->add(operation_kind_t::update_k, workload.update_proportion);
     chooser->add(operation_kind_t::remove_k, workload.remove_proportion);
@@ -285,166 +450,534 @@ operation_chooser_ptr_t create_operation_chooser(workload_t const& workload) {
     return chooser;
 }
 
-struct progress_t {
-    size_t entries_touched = 0;
-    size_t bytes_processed = 0;
+void set_latency_counters(bm::State& state, operations_histogram_t const& histogram) {
+
+    // clang-format off
 
-    size_t done_iterations = 0;
-    size_t failed_iterations = 0;
-    size_t last_printed_iterations = 0;
-    size_t total_iterations = 0;
+    // Note: The total latency counters are also used in the reporter
+    latency_histogram_t total = histogram.total();
+    state.counters["latency_avg,ns"] = bm::Counter(total.mean());
+    state.counters["latency_p50,ns"] = bm::Counter(total.percentile(50.0));
+    state.counters["latency_p99,ns"] = bm::Counter(total.percentile(99.0));
+    state.counters["latency_p99.9,ns"] = bm::Counter(total.percentile(99.9));
+    state.counters["latency_max,ns"] = bm::Counter(total.max());
+
+    for (size_t idx = 0; idx != operations_histogram_t::operations_count_k; ++idx) {
+        auto operation = operation_kind_t(idx);
+        auto const& op_histogram = histogram[operation];
+        if (!op_histogram.count())
+            continue;
+
+        auto name = operation_name(operation);
+        state.counters[fmt::format("latency_avg({}),ns", name)] = bm::Counter(op_histogram.mean());
+        state.counters[fmt::format("latency_p50({}),ns", name)] = bm::Counter(op_histogram.percentile(50.0));
+        state.counters[fmt::format("latency_p99({}),ns", name)] = bm::Counter(op_histogram.percentile(99.0));
+        state.counters[fmt::format("latency_p99.9({}),ns", name)] = bm::Counter(op_histogram.percentile(99.9));
+        state.counters[fmt::format("latency_max({}),ns", name)] = bm::Counter(op_histogram.max());
+    }
+
+    // clang-format on
+}
 
-    int64_t prev_ops_per_second = 0.0;
+void set_batch_counters(bm::State& state, batches_histogram_t const& batches) {
 
-    static void print_db_open() {
-        fmt::print("\33[2K\r");
-        fmt::print(" [✱] Opening DB...\r");
-        fflush(stdout);
+    // clang-format off
+
+    for (size_t idx = 0; idx != operations_histogram_t::operations_count_k; ++idx) {
+        auto operation = operation_kind_t(idx);
+        if (!batches_histogram_t::tracks(operation))
+            continue;
+
+        auto name = operation_name(operation);
+        for (size_t group = 0; group != batches_histogram_t::length_groups_k; ++group) {
+            auto const& histogram = batches.latencies(operation, group);
+            if (!histogram.count())
+                continue;
+
+            // Note: The last group is open-ended
+            auto lengths = group + 1 == batches_histogram_t::length_groups_k
+                               ? fmt::format("{}+", batches_histogram_t::group_min_length(group))
+                               : fmt::format("{}-{}", batches_histogram_t::group_min_length(group), batches_histogram_t::group_max_length(group));
+            auto entries = batches.entries(operation, group);
+            double per_entry = entries ? histogram.mean() * histogram.count() / entries : 0.0;
+            state.counters[fmt::format("operations({},{})", name, lengths)] = bm::Counter(histogram.count());
+            state.counters[fmt::format("latency_p50({},{}),ns", name, lengths)] = bm::Counter(histogram.percentile(50.0));
+            state.counters[fmt::format("latency_p99({},{}),ns", name, lengths)] = bm::Counter(histogram.percentile(99.0));
+            state.counters[fmt::format("latency_per_entry({},{}),ns", name, lengths)] = bm::Counter(per_entry);
+        }
     }
 
-    static void print_db_close() {
-        fmt::print("\33[2K\r");
-        fmt::print(" [✱] Closing DB...\r");
-        fflush(stdout);
+    // clang-format on
+}
+
+void set_phase_counters(bm::State& state, workload_t const& workload, std::vector<phase_stats_t> const& phases) {
+
+    // clang-format off
+
+    for (size_t idx = 0; idx != phases.size(); ++idx) {
+        auto const& phase = phases[idx];
+        auto const& name = workload.phases[idx].name;
+        state.counters[fmt::format("phase_duration({}),s", name)] = bm::Counter(phase.elapsed_ns / 1e9);
+        state.counters[fmt::format("phase_operations/s({})", name)] = bm::Counter(phase.entries_per_second());
+        state.counters[fmt::format("phase_latency_p50({}),ns", name)] = bm::Counter(phase.latencies.percentile(50.0));
+        state.counters[fmt::format("phase_latency_p99({}),ns", name)] = bm::Counter(phase.latencies.percentile(99.0));
+        state.counters[fmt::format("phase_latency_p99.9({}),ns", name)] = bm::Counter(phase.latencies.percentile(99.9));
+        state.counters[fmt::format("phase_recovery({}),s", name)] = bm::Counter(phase.recovery_seconds());
+    }
+
+    // clang-format on
+}
+
+/**
+ * @brief Checks the Zipfian generator against theory. Draws ranks from one with the parameters of the workload,
+ * and compares the shares of the most popular ones with the expected `H(top, theta) / H(items, theta)`.
+ * Note: Hot set shifts and scrambling move popular keys around, but don't change their shares.
+ */
+void set_zipfian_counters(bm::State& state, workload_t const& workload, uint64_t seed) {
+
+    constexpr size_t samples_k = 1'000'000;
+    constexpr std::array<size_t, 3> tops_k {1, 10, 100};
+    size_t items_count = std::max(workload.records_count, size_t(2));
+    core::zipfian_generator_t generator(items_count, core::xoshiro256ss_t(seed), workload.zipfian_theta);
+    std::vector<size_t> ranks(samples_k);
+    generator.fill(ranks);
+
+    std::array<size_t, tops_k.size()> hits {};
+    for (size_t rank : ranks)
+        for (size_t idx = 0; idx != tops_k.size(); ++idx)
+            hits[idx] += rank < tops_k[idx];
+
+    // clang-format off
+
+    double zeta_n = core::zipfian_generator_t::zeta(items_count, workload.zipfian_theta);
+    state.counters["zipfian_theta"] = bm::Counter(workload.zipfian_theta);
+    for (size_t idx = 0; idx != tops_k.size(); ++idx) {
+        double expected = core::zipfian_generator_t::zeta(tops_k[idx], workload.zipfian_theta) / zeta_n;
+        state.counters[fmt::format("zipfian_top{}(measured),%", tops_k[idx])] = bm::Counter(hits[idx] * 100.0 / samples_k);
+        state.counters[fmt::format("zipfian_top{}(theory),%", tops_k[idx])] = bm::Counter(expected * 100.0);
     }
 
-    static void print_db_flush() {
-        fmt::print("\33[2K\r");
-        fmt::print(" [✱] Flushing DB...\r");
-        fflush(stdout);
+    // clang-format on
+}
+
+void set_slo_counters(bm::State& state,
+                      workload_t const& workload,
+                      std::vector<phase_stats_t> const& steps,
+                      slo_search_t const& search) {
+
+    // clang-format off
+
+    // Note: The last step isn't judged by the search itself, so all of them are judged here the same way
+    auto const& slo = workload.slo;
+    auto percentile = fmt::format("p{}", slo.percentile);
+    double best_throughput = 0;
+    double best_target = 0;
+    for (size_t idx = 0; idx != std::min(steps.size(), search.rates().size()); ++idx) {
+        auto const& step = steps[idx];
+        auto const& name = workload.phases[idx].name;
+        double latency = step.latencies.percentile(slo.percentile);
+        bool met = step.latencies.count() && slo.met(latency);
+        state.counters[fmt::format("phase_target_operations/s({})", name)] = bm::Counter(search.rates()[idx]);
+        state.counters[fmt::format("phase_latency_{}({}),ns", percentile, name)] = bm::Counter(latency);
+        state.counters[fmt::format("phase_slo_met({})", name)] = bm::Counter(met);
+        if (met && search.rates()[idx] > best_target) {
+            best_target = search.rates()[idx];
+            best_throughput = step.entries_per_second();
+        }
     }
+    state.counters[fmt::format("slo_latency_{},ns", percentile)] = bm::Counter(slo.latency_ms * 1'000'000);
+    state.counters["slo_target_operations/s"] = bm::Counter(best_target);
+    state.counters["slo_operations/s"] = bm::Counter(best_throughput);
+
+    // clang-format on
+}
+
+void set_group_counters(bm::State& state, workload_t const& workload, threads_stats_t const& threads_stats) {
+
+    // clang-format off
 
-    static void clear_last_print() {
-        fmt::print("\33[2K\r");
-        fflush(stdout);
+    for (size_t idx = 0; idx != workload.groups.size(); ++idx) {
+        auto group_stats = std::make_unique<thread_stats_t>();
+        for (size_t thread_idx = 0; thread_idx != size_t(state.threads()); ++thread_idx)
+            if (threads_stats[thread_idx].group == idx)
+                group_stats->merge(threads_stats[thread_idx]);
+
+        auto const& group = workload.groups[idx];
+        auto const& totals = group_stats->counters;
+        latency_histogram_t latencies = group_stats->latencies.total();
+        state.counters[fmt::format("group_threads({})", group.name)] = bm::Counter(group.threads_count);
+        state.counters[fmt::format("group_operations/s({})", group.name)] = bm::Counter(totals.entries_touched, bm::Counter::kIsRate);
+        state.counters[fmt::format("group_fails({}),%", group.name)] = bm::Counter(totals.done_operations ? totals.failed_operations * 100.0 / totals.done_operations : 0.0);
+        state.counters[fmt::format("group_latency_p50({}),ns", group.name)] = bm::Counter(latencies.percentile(50.0));
+        state.counters[fmt::format("group_latency_p99({}),ns", group.name)] = bm::Counter(latencies.percentile(99.0));
+        state.counters[fmt::format("group_latency_p99.9({}),ns", group.name)] = bm::Counter(latencies.percentile(99.9));
+        if (group.target_ops_per_second > 0)
+            state.counters[fmt::format("group_target_operations/s({})", group.name)] = bm::Counter(group.target_ops_per_second);
     }
 
-    void print_start(std::string const& workload_name) {
-        fmt::print("\33[2K\r");
-        auto name = fmt::format(fmt::fg(fmt::color::light_green), "{}", workload_name);
-        fmt::print(" [✱] {}: 0.00%\r", name, 0.0);
-        fflush(stdout);
+    // clang-format on
+}
+
+void set_allocation_counters(bm::State& state, thread_stats_t const& stats) {
+
+    allocations_t total;
+    size_t total_operations = 0;
+    for (size_t idx = 0; idx != operations_histogram_t::operations_count_k; ++idx) {
+        auto operation = operation_kind_t(idx);
+        size_t operations = stats.latencies[operation].count();
+        if (!operations)
+            continue;
+
+        auto const& allocations = stats.allocations[idx];
+        auto name = operation_name(operation);
+        state.counters[fmt::format("allocations_per_op({})", name)] = bm::Counter(double(allocations.count) / operations);
+        state.counters[fmt::format("allocated_per_op({}),bytes", name)] = bm::Counter(double(allocations.bytes) / operations);
+        total.merge(allocations);
+        total_operations += operations;
     }
 
-    void print_end() {
-        fmt::print("\33[2K\r");
-        fmt::print(" [✱] Completed\r");
-        fflush(stdout);
+    if (total_operations) {
+        state.counters["allocations_per_op"] = bm::Counter(double(total.count) / total_operations);
+        state.counters["allocated_per_op,bytes"] = bm::Counter(double(total.bytes) / total_operations);
     }
+}
 
-    bool is_time_to_print() {
-        auto print_iterations_step = std::max(size_t(0.05 * total_iterations), size_t(1));
-        auto done_its = atomic_load(done_iterations);
-        return done_its - atomic_load(last_printed_iterations) >= print_iterations_step || done_its == total_iterations;
+void set_hw_counters(bm::State& state, std::string const& scope, hw_counters_t const& counters, size_t operations) {
+
+    auto suffix = scope.empty() ? std::string() : fmt::format("({})", scope);
+    state.counters[fmt::format("ipc{}", suffix)] = bm::Counter(counters.ipc());
+    for (size_t idx = 0; idx != hw_counters_t::events_count_k; ++idx) {
+        auto event = hw_event_t(idx);
+        if (!perf_counters_t::supported(event))
+            continue;
+        double per_operation = operations ? double(counters[event]) / operations : 0.0;
+        state.counters[fmt::format("{}{}/op", hw_event_name(event), suffix)] = bm::Counter(per_operation);
     }
+}
 
-    void print(std::string const& workload_name, elapsed_time_t operations_elapsed_time, elapsed_time_t elapsed_time) {
+void set_io_counters(bm::State& state, io_profiler_t const& io_prof, thread_stats_t::counters_t const& totals) {
 
-        auto done_percent = 100.f * done_iterations / total_iterations;
-        auto fails_percent = failed_iterations * 100.0 / done_iterations;
-        auto ops_per_second = entries_touched / std::chrono::duration<double>(operations_elapsed_time).count();
-        auto opps_delta = int64_t(ops_per_second) - prev_ops_per_second;
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_time).count();
-        auto remaining = std::chrono::milliseconds(size_t((elapsed / done_percent) * (100.f - done_percent))).count();
+    // clang-format off
 
-        fmt::print("\33[2K\r");
-        auto name = fmt::format(fmt::fg(fmt::color::light_green), "{}", workload_name);
-        std::string delta;
-        if (opps_delta < 0 && std::abs(opps_delta) > prev_ops_per_second * 0.0001)
-            delta = fmt::format(fmt::fg(fmt::color::red), "▼");
-        else if (opps_delta > 0 && std::abs(opps_delta) > prev_ops_per_second * 0.0001)
-            delta = fmt::format(fmt::fg(fmt::color::green), "▲");
-        auto fails = fails_percent == 0.0 ? fmt::format("{:g}%", fails_percent)
-                                          : fmt::format(fmt::fg(fmt::color::red), "{:g}%", fails_percent);
-        fmt::print(" [✱] {}: {:.2f}% [{}/s {}| fails: {} | elapsed: {} | left: {}]\r",
-                   name,
-                   done_percent,
-                   printable_float_t {ops_per_second},
-                   delta,
-                   fails,
-                   printable_duration_t {size_t(elapsed)},
-                   printable_duration_t {size_t(remaining)});
-        fflush(stdout);
+    auto io = io_prof.counters();
+    state.counters["io_read(process),bytes"] = bm::Counter(io.process_read_bytes, bm::Counter::kDefaults, bm::Counter::kIs1024);
+    state.counters["io_written(process),bytes"] = bm::Counter(io.process_written_bytes, bm::Counter::kDefaults, bm::Counter::kIs1024);
+    if (totals.bytes_read)
+        state.counters["read_amplification(process)"] = bm::Counter(double(io.process_read_bytes) / totals.bytes_read);
+    if (totals.bytes_written)
+        state.counters["write_amplification(process)"] = bm::Counter(double(io.process_written_bytes) / totals.bytes_written);
 
-        atomic_store(last_printed_iterations, done_iterations);
-        atomic_store(prev_ops_per_second, int64_t(ops_per_second));
-    }
+    // Note: Device counters are also used in the reporter
+    if (!io_prof.has_devices())
+        return;
+    size_t requests = io.device_read_requests + io.device_write_requests;
+    state.counters["io_read(device),bytes"] = bm::Counter(io.device_read_bytes, bm::Counter::kDefaults, bm::Counter::kIs1024);
+    state.counters["io_written(device),bytes"] = bm::Counter(io.device_written_bytes, bm::Counter::kDefaults, bm::Counter::kIs1024);
+    state.counters["io_requests/op"] = bm::Counter(totals.done_operations ? double(requests) / totals.done_operations : 0.0);
+    if (totals.bytes_read)
+        state.counters["read_amplification"] = bm::Counter(double(io.device_read_bytes) / totals.bytes_read);
+    if (totals.bytes_written)
+        state.counters["write_amplification"] = bm::Counter(double(io.device_written_bytes) / totals.bytes_written);
 
-    void clear() {
-        failed_iterations = 0;
-        entries_touched = 0;
-        bytes_processed = 0;
-        done_iterations = 0;
-        last_printed_iterations = 0;
-        total_iterations = 0;
-        prev_ops_per_second = 0;
-    }
-};
+    // clang-format on
+}
+
+fs::path timeseries_file_path(settings_t const& settings, std::string const& workload_name) {
+    return fmt::format("{}/{}.{}.ndjson",
+                       settings.results_file_path.parent_path().string(),
+                       settings.results_file_path.filename().stem().string(),
+                       workload_name);
+}
 
-void bench(bm::State& state, workload_t const& workload, db_t& db, data_accessor_t& data_accessor) {
+fs::path trace_file_path(settings_t const& settings, std::string const& workload_name) {
+    return settings.trace_dir_path / fmt::format("{}.trace", workload_name);
+}
+
+fs::path trace_part_file_path(settings_t const& settings, std::string const& workload_name, size_t thread_idx) {
+    return settings.trace_dir_path / fmt::format("{}.trace.{}", workload_name, thread_idx);
+}
+
+void bench(bm::State& state,
+           workload_t const& workload,
+           db_t& db,
+           data_accessor_t& data_accessor,
+           settings_t const& settings,
+           threads_placement_t const& placement,
+           threads_fence_t& fence,
+           threads_stats_t& threads_stats) {
+
+    // Note: Pinned before the worker allocates, so that its buffers are first touched on the right node
+    thread_placement_guard_t placement_guard(placement, state.thread_index());
 
     // Bench components
-    auto chooser = create_operation_chooser(workload);
+    core::random_streams_t streams(settings.seed, state.thread_index());
+    auto chooser = create_operation_chooser(workload, streams);
     ucsb::timer_t timer(state);
-    worker_t worker(workload, data_accessor, timer);
-    std::atomic_bool do_flash = true;
+    // Note: The recorder wraps the accessor, so traces hold exactly what the DB was asked to do
+    std::optional<trace_recorder_t> recorder;
+    if (!settings.trace_dir_path.empty())
+        recorder.emplace(data_accessor, trace_part_file_path(settings, workload.name, state.thread_index()));
+    data_accessor_t& worker_accessor = recorder ? *recorder : data_accessor;
+    worker_t worker(workload, worker_accessor, timer, streams, settings.huge_pages);
+    pacer_t pacer(workload.target_ops_per_second / workload.threads_count);
+    static std::atomic_size_t finished_threads_count = 0; // Shared between threads
+    static slo_search_t slo_search;                        // Shared between threads, driven by the first one
+
+    // Monitoring (only one thread profiles, monitors and samples)
+    cpu_profiler_t cpu_prof(settings.profile_interval);
+    mem_profiler_t mem_prof(settings.profile_interval);
+    progress_t progress(threads_stats);
+    sampler_t sampler(threads_stats, cpu_prof, mem_prof, settings.sample_interval);
+    auto& stats = threads_stats[state.thread_index()];
+    std::vector<fs::path> db_dir_paths = settings.db_storage_dir_paths;
+    db_dir_paths.push_back(settings.db_main_dir_path);
+    io_profiler_t io_prof(db_dir_paths);
+
+    // Hardware counters of this worker, and of the whole process including DB background threads
+    perf_counters_t thread_perf;
+    perf_counters_t process_perf;
+    if (settings.perf_counters) {
+        thread_perf.open(perf_counters_t::scope_t::thread_k);
+        if (state.thread_index() == 0)
+            process_perf.open(perf_counters_t::scope_t::process_k);
+    }
 
-    // Monitoring
-    cpu_profiler_t cpu_prof;    // Only one thread profiles
-    mem_profiler_t mem_prof;    // Only one thread profiles
-    static progress_t progress; // Shared between threads
+    // Dispatches the operation to the worker
+    auto do_operation = [&](operation_kind_t operation) {
+        switch (operation) {
+        case operation_kind_t::upsert_k: return worker.do_upsert();
+        case operation_kind_t::update_k: return worker.do_update();
+        case operation_kind_t::remove_k: return worker.do_remove();
+        case operation_kind_t::read_k: return worker.do_read();
+        case operation_kind_t::read_modify_write_k: return worker.do_read_modify_write();
+        case operation_kind_t::batch_upsert_k: return worker.do_batch_upsert();
+        case operation_kind_t::batch_read_k: return worker.do_batch_read();
+        case operation_kind_t::bulk_load_k: return worker.do_bulk_load();
+        case operation_kind_t::range_select_k: return worker.do_range_select();
+        case operation_kind_t::scan_k: return worker.do_scan();
+        default: throw exception_t("Unknown operation");
+        }
+    };
+
+    // Note: With a deeper queue, operations are submitted without waiting and complete in any order
+    std::unique_ptr<async_queue_t> queue;
+    std::vector<time_point_t> requests_start_times;
+    std::vector<async_request_t*> completed_requests;
+    if (settings.queue_depth > 1) {
+        queue = worker_accessor.create_async_queue(settings.queue_depth);
+        worker.reserve_requests(settings.queue_depth);
+        requests_start_times.resize(settings.queue_depth);
+        completed_requests.resize(settings.queue_depth);
+    }
 
-    // Bench initialization
-    atomic_add_fetch(progress.total_iterations, workload.operations_count);
+    // Note: Operations are generated either inline, or in chunks outside of the measured time
+    size_t planned_operations = workload.warmup_operations + workload.operations_count;
+    size_t pregenerate_chunk = settings.pregenerate_chunk;
+    if (worker.replaying() && !pregenerate_chunk)
+        pregenerate_chunk = worker_t::replay_chunk_k;
+    if (pregenerate_chunk)
+        worker.pregenerate(*chooser, std::min(pregenerate_chunk, planned_operations));
+
+    // Warm-up (operations are done, but neither timed, nor accounted, nor profiled)
+    if (warms_up(workload)) {
+        if (state.thread_index() == 0)
+            progress_t::print_warmup(workload.name);
+        auto warmup_deadline = high_resolution_clock_t::now() + seconds_to_duration(workload.warmup_s);
+        size_t warmup_operations = 0;
+        while (warmup_operations < workload.warmup_operations || high_resolution_clock_t::now() < warmup_deadline) {
+            if (worker.pregenerated() && !worker.pregenerated_left())
+                worker.pregenerate(*chooser, pregenerate_chunk);
+            // Note: Only replayed traces run out of operations
+            if (worker.pregenerated() && !worker.pregenerated_left())
+                break;
+            do_operation(worker.next_operation(*chooser));
+            ++warmup_operations;
+        }
+        // Note: The measured phase starts for all threads at once
+        fence.sync();
+    }
+
+    // Bench initialization (monitoring threads shouldn't inherit the placement of the worker)
     if (state.thread_index() == 0) {
-        cpu_prof.start();
-        mem_prof.start();
-        progress.print_start(workload.name);
+        placement_guard.unpinned([&] {
+            cpu_prof.start();
+            mem_prof.start();
+            io_prof.start();
+            sampler.start(workload.name, timeseries_file_path(settings, workload.name));
+            progress.start(workload.name, state.threads(), workload.duration_s);
+        });
+        process_perf.start();
+        if (workload.slo.enabled())
+            slo_search.start(workload.slo);
     }
 
     // Bench
-    timer.start();
+    elapsed_time_t replay_origin(0);
+    thread_perf.start();
     while (state.KeepRunningBatch(workload.operations_count)) {
-        size_t thread_iterations = workload.operations_count;
-        while (thread_iterations) {
-            // Do operation
-            operation_result_t result;
-            auto operation = chooser->choose();
-            switch (operation) {
-            case operation_kind_t::upsert_k: result = worker.do_upsert(); break;
-            case operation_kind_t::update_k: result = worker.do_update(); break;
-            case operation_kind_t::remove_k: result = worker.do_remove(); break;
-            case operation_kind_t::read_k: result = worker.do_read(); break;
-            case operation_kind_t::read_modify_write_k: result = worker.do_read_modify_write(); break;
-            case operation_kind_t::batch_upsert_k: result = worker.do_batch_upsert(); break;
-            case operation_kind_t::batch_read_k: result = worker.do_batch_read(); break;
-            case operation_kind_t::bulk_load_k: result = worker.do_bulk_load(); break;
-            case operation_kind_t::range_select_k: result = worker.do_range_select(); break;
-            case operation_kind_t::scan_k: result = worker.do_scan(); break;
-            default: throw exception_t("Unknown operation"); break;
-            }
+        // Note: All threads have just passed the starting barrier, so they switch phases and stop at the same time
+        bool time_bounded = workload.duration_s > 0;
+        // Note: Time and schedules start here, so the monitoring startup by the first thread counts as neither
+        timer.start();
+        pacer.start();
+        auto now = high_resolution_clock_t::now();
+        auto deadline = now + seconds_to_duration(workload.duration_s);
+        size_t phase_idx = 0;
+        auto phase_start_time = now;
+        auto phase_end_time = deadline;
+        if (!workload.phases.empty())
+            phase_end_time = now + seconds_to_duration(workload.phases.front().duration_s);
+
+        auto account_operation = [&](operation_kind_t operation,
+                                     operation_result_t result,
+                                     size_t batch_length,
+                                     size_t operation_latency) {
+            stats.latencies.record(operation, operation_latency);
+            if (batches_histogram_t::tracks(operation))
+                stats.batches.record(operation, batch_length, operation_latency);
 
             // Update progress
             bool success = result.status == operation_status_t::ok_k;
-            auto bytes_processed = size_t(success) * workload.value_length * result.entries_touched;
-            atomic_add_fetch(progress.entries_touched, size_t(success) * result.entries_touched);
-            atomic_add_fetch(progress.failed_iterations, size_t(!success));
-            atomic_add_fetch(progress.bytes_processed, bytes_processed);
-            auto done_iterations = atomic_add_fetch(progress.done_iterations, size_t(1));
-
-            if (progress.is_time_to_print())
-                progress.print(workload.name, timer.operations_elapsed_time(), timer.elapsed_time());
-
-            // Last thread flushes the DB
-            bool only_once = true;
-            bool is_last_iteration = done_iterations == progress.total_iterations;
-            if (is_last_iteration && do_flash.compare_exchange_weak(only_once, false)) {
-                progress_t::print_db_flush();
-                db.flush();
+            auto entries_touched = size_t(success) * result.entries_touched;
+            auto bytes_processed = workload.value_length * entries_touched;
+            stats.counters.add_operation(operation, success, entries_touched, bytes_processed);
+            if (!stats.phases.empty())
+                stats.phases[phase_idx].record(now - phase_start_time, operation_latency, entries_touched);
+        };
+        // Note: Latencies of asynchronous operations are measured from their submission to their completion
+        auto complete_requests = [&](bool wait) {
+            size_t count = queue->poll(completed_requests, wait);
+            auto completion_time = high_resolution_clock_t::now();
+            for (size_t idx = 0; idx != count; ++idx) {
+                auto& request = *completed_requests[idx];
+                auto latency =
+                    std::chrono::duration_cast<elapsed_time_t>(completion_time - requests_start_times[request.tag]);
+                size_t batch_length = request.operation == operation_kind_t::range_select_k ? request.length
+                                                                                             : request.keys.size();
+                account_operation(request.operation, request.result, batch_length, latency.count());
+                worker.release_request(request);
             }
+            if (count)
+                stats.counters.set_operations_time(timer.operations_elapsed_time());
+        };
+
+        // Note: Searches are bounded by time only, as all threads must reach the end of every step
+        size_t thread_iterations =
+            workload.slo.enabled() ? std::numeric_limits<size_t>::max() : workload.operations_count;
+        while (thread_iterations) {
+            if (time_bounded) {
+                now = high_resolution_clock_t::now();
+                // Note: Searches end with their last step instead, as every thread must sync at every boundary
+                if (!workload.slo.enabled() && now >= deadline)
+                    break;
+                // Note: Phases end on schedule, but the next one starts once generators are switched
+                while (phase_idx + 1 < workload.phases.size() && now >= phase_end_time) {
+                    // Note: Every step of a search is judged by its own operations only
+                    while (workload.slo.enabled() && queue && queue->in_flight())
+                        complete_requests(true);
+                    stats.phases[phase_idx].finish(now - phase_start_time);
+                    auto const& phase = workload.phases[++phase_idx];
+                    timer.pause();
+                    chooser = create_operation_chooser(phase, streams);
+                    worker.switch_phase(phase);
+                    if (workload.slo.enabled()) {
+                        // Note: All threads wait, until the first one judges the step and picks the next rate
+                        fence.sync();
+                        if (state.thread_index() == 0) {
+                            latency_histogram_t latencies;
+                            for (size_t thread_idx = 0; thread_idx != size_t(state.threads()); ++thread_idx)
+                                latencies.merge(threads_stats[thread_idx].phases[phase_idx - 1].latencies);
+                            slo_search.step(latencies.percentile(workload.slo.percentile));
+                        }
+                        fence.sync();
+                        pacer.set_rate(slo_search.rate() / workload.threads_count);
+                        pacer.start();
+                    }
+                    timer.resume();
+                    now = high_resolution_clock_t::now();
+                    phase_start_time = now;
+                    // Note: Steps last in full, not counting the time spent judging the previous one
+                    if (workload.slo.enabled())
+                        phase_end_time = now + seconds_to_duration(phase.duration_s);
+                    else
+                        phase_end_time += seconds_to_duration(phase.duration_s);
+                }
+                // Note: Boundaries are all passed by now, so only the last step can end here
+                if (workload.slo.enabled() && now >= phase_end_time)
+                    break;
+            }
+            if (worker.pregenerated() && !worker.pregenerated_left()) {
+                timer.pause();
+                worker.pregenerate(*chooser, std::min(pregenerate_chunk, thread_iterations));
+                timer.resume();
+                if (!worker.pregenerated_left())
+                    break;
+            }
+
+            // Wait for the scheduled time in open-loop mode, or for the recorded one when replaying
+            elapsed_time_t schedule_lag(0);
+            if (workload.replay_original_timing) {
+                // Note: The schedule starts from the first measured operation, skipping the warm-up
+                if (thread_iterations == workload.operations_count)
+                    replay_origin = worker.next_arrival();
+                schedule_lag = pacer.wait_since_start(worker.next_arrival() - replay_origin);
+                stats.schedule_lags.record(schedule_lag.count());
+            }
+            else if (pacer.enabled()) {
+                schedule_lag = pacer.wait();
+                stats.schedule_lags.record(schedule_lag.count());
+            }
+
+            // Do operation
+            auto operation = worker.next_operation(*chooser);
+            allocations_t operation_start_allocations;
+            if (queue) {
+                // Note: Waits for a free request, accounting the completed ones
+                while (!worker.has_free_request())
+                    complete_requests(true);
+                if constexpr (allocations_counted_k)
+                    operation_start_allocations = thread_allocations();
+                async_request_t& request = worker.prepare_request(operation);
+                requests_start_times[request.tag] = high_resolution_clock_t::now() - schedule_lag;
+                queue->submit(request);
+                if constexpr (allocations_counted_k)
+                    stats.allocations[size_t(operation)].add(thread_allocations() - operation_start_allocations);
+                complete_requests(false);
+                --thread_iterations;
+                continue;
+            }
+
+            // Note: Data preparation time is excluded, as worker pauses the timer for it
+            if constexpr (allocations_counted_k)
+                operation_start_allocations = thread_allocations();
+            auto operation_start_time = timer.operations_elapsed_time();
+            operation_result_t result = do_operation(operation);
+            auto operation_end_time = timer.operations_elapsed_time();
+            auto operation_elapsed_time = operation_end_time - operation_start_time;
+            if constexpr (allocations_counted_k)
+                stats.allocations[size_t(operation)].add(thread_allocations() - operation_start_allocations);
+            auto operation_latency = (schedule_lag + operation_elapsed_time).count();
+            account_operation(operation, result, worker.last_batch_length(), operation_latency);
+            stats.counters.set_operations_time(operation_end_time);
 
             --thread_iterations;
         }
+        while (queue && queue->in_flight())
+            complete_requests(true);
+        if (!stats.phases.empty())
+            stats.phases[phase_idx].finish(high_resolution_clock_t::now() - phase_start_time);
+
+        // Note: Must be stored before the benchmark barrier, as the first thread reads it right after
+        thread_perf.stop();
+        stats.hw_counters.store(thread_perf.read());
+        if (recorder)
+            recorder->close();
+
+        // Last thread flushes the DB
+        if (finished_threads_count.fetch_add(1) + 1 == size_t(state.threads())) {
+            progress_t::print_db_flush();
+            db.flush();
+        }
     }
     timer.stop();
 
@@ -452,50 +985,148 @@ void bench(bm::State& state, workload_t const& workload, db_t& db, data_accessor
 
     // Conclusion
     if (state.thread_index() == 0) {
-        progress.print_end();
+        process_perf.stop();
+        io_prof.stop();
+        progress.stop();
+        sampler.stop();
         cpu_prof.stop();
         mem_prof.stop();
 
+        // Note: All threads have passed the benchmark barrier, so their stats are final
+        auto merged_stats = std::make_unique<thread_stats_t>();
+        for (auto const& thread_stats : threads_stats)
+            merged_stats->merge(thread_stats);
+        auto const& totals = merged_stats->counters;
+        finished_threads_count = 0;
+
         // Note: This counters are hardcoded and also used in the reporter, so if you do any change here you should also change in the reporter
-        state.SetBytesProcessed(progress.bytes_processed);
-        state.counters["fails,%"] = bm::Counter(progress.failed_iterations * 100.0 / progress.done_iterations);
-        state.counters["operations/s"] = bm::Counter(progress.entries_touched, bm::Counter::kIsRate);
+        state.SetBytesProcessed(totals.bytes_processed);
+        state.counters["fails,%"] = bm::Counter(totals.failed_operations * 100.0 / totals.done_operations);
+        state.counters["operations/s"] = bm::Counter(totals.entries_touched, bm::Counter::kIsRate);
         state.counters["cpu_max,%"] = bm::Counter(cpu_prof.percent().max);
         state.counters["cpu_avg,%"] = bm::Counter(cpu_prof.percent().avg);
         state.counters["mem_max(rss),bytes"] = bm::Counter(mem_prof.rss().max, bm::Counter::kDefaults, bm::Counter::kIs1024);
         state.counters["mem_avg(rss),bytes"] = bm::Counter(mem_prof.rss().avg, bm::Counter::kDefaults, bm::Counter::kIs1024);
         state.counters["mem_max(vm),bytes"] = bm::Counter(mem_prof.vm().max, bm::Counter::kDefaults, bm::Counter::kIs1024);
         state.counters["mem_avg(vm),bytes"] = bm::Counter(mem_prof.vm().avg, bm::Counter::kDefaults, bm::Counter::kIs1024);
-        state.counters["processed,bytes"] = bm::Counter(progress.bytes_processed, bm::Counter::kDefaults, bm::Counter::kIs1024);
-        state.counters["disk,bytes"] = bm::Counter(db.size_on_disk(), bm::Counter::kDefaults, bm::Counter::kIs1024);
-
-        progress.clear();
+        auto roles_time = cpu_prof.roles_time();
+        for (size_t idx = 0; idx != thread_roles_t::roles_count_k; ++idx) {
+            auto role = thread_role_t(idx);
+            state.counters[fmt::format("cpu({}),s", thread_role_name(role))] = bm::Counter(roles_time.cpu_seconds(role));
+            state.counters[fmt::format("cores({})", thread_role_name(role))] = bm::Counter(roles_time.cores(role));
+        }
+        state.counters["faults(minor)"] = bm::Counter(mem_prof.minor_faults());
+        state.counters["faults(major)"] = bm::Counter(mem_prof.major_faults());
+        if (mem_prof.has_rss_details()) {
+            state.counters["mem_max(anon),bytes"] = bm::Counter(mem_prof.rss_anon().max, bm::Counter::kDefaults, bm::Counter::kIs1024);
+            state.counters["mem_avg(anon),bytes"] = bm::Counter(mem_prof.rss_anon().avg, bm::Counter::kDefaults, bm::Counter::kIs1024);
+            state.counters["mem_max(file),bytes"] = bm::Counter(mem_prof.rss_file().max, bm::Counter::kDefaults, bm::Counter::kIs1024);
+            state.counters["mem_avg(file),bytes"] = bm::Counter(mem_prof.rss_file().avg, bm::Counter::kDefaults, bm::Counter::kIs1024);
+            state.counters["mem_max(shared),bytes"] = bm::Counter(mem_prof.rss_shared().max, bm::Counter::kDefaults, bm::Counter::kIs1024);
+            state.counters["mem_avg(shared),bytes"] = bm::Counter(mem_prof.rss_shared().avg, bm::Counter::kDefaults, bm::Counter::kIs1024);
+        }
+        state.counters["processed,bytes"] = bm::Counter(totals.bytes_processed, bm::Counter::kDefaults, bm::Counter::kIs1024);
+        size_t disk_size = db.size_on_disk();
+        state.counters["disk,bytes"] = bm::Counter(disk_size, bm::Counter::kDefaults, bm::Counter::kIs1024);
+        // Note: Relative to the workload size, so it also includes the overheads of keys, indexes and logs
+        size_t workload_size = workload.db_records_count * workload.value_length;
+        state.counters["value_compression_ratio"] = bm::Counter(workload.value_compression_ratio);
+        if (disk_size)
+            state.counters["compression_ratio(disk)"] = bm::Counter(double(disk_size) / workload_size);
+
+        set_latency_counters(state, merged_stats->latencies);
+        set_batch_counters(state, merged_stats->batches);
+        if constexpr (allocations_counted_k)
+            set_allocation_counters(state, *merged_stats);
+        set_phase_counters(state, workload, merged_stats->phases);
+        set_group_counters(state, workload, threads_stats);
+        if (workload.slo.enabled())
+            set_slo_counters(state, workload, merged_stats->phases, slo_search);
+        if (workload.key_dist == distribution_kind_t::zipfian_k || workload.key_dist == distribution_kind_t::skewed_latest_k)
+            set_zipfian_counters(state, workload, settings.seed);
+        if (recorder) {
+            std::vector<fs::path> part_paths;
+            for (size_t thread_idx = 0; thread_idx != size_t(state.threads()); ++thread_idx)
+                part_paths.push_back(trace_part_file_path(settings, workload.name, thread_idx));
+            merge_traces(part_paths, trace_file_path(settings, workload.name));
+            for (auto const& part_path : part_paths)
+                fs::remove(part_path);
+        }
+        set_io_counters(state, io_prof, totals);
+        if (process_perf.opened())
+            set_hw_counters(state, "", process_perf.read(), totals.done_operations);
+        if (merged_stats->hw_counters.targets == size_t(state.threads()))
+            set_hw_counters(state, "workers", merged_stats->hw_counters, totals.done_operations);
+        if (queue)
+            state.counters["queue_depth"] = bm::Counter(queue->depth());
+        // Note: In grouped workloads, rates are per group, and in searches, per step
+        if (pacer.enabled() && workload.groups.empty() && !workload.slo.enabled())
+            state.counters["target_operations/s"] = bm::Counter(workload.target_ops_per_second);
+        if (pacer.enabled() || workload.replay_original_timing) {
+            auto const& lags = merged_stats->schedule_lags;
+            state.counters["schedule_lag_avg,ns"] = bm::Counter(lags.mean());
+            state.counters["schedule_lag_p99,ns"] = bm::Counter(lags.percentile(99.0));
+            state.counters["schedule_lag_max,ns"] = bm::Counter(lags.max());
+        }
     }
 
     // clang-format on
 }
 
-void bench(bm::State& state, workload_t const& workload, db_t& db, bool transactional, threads_fence_t& fence) {
+/**
+ * @brief A workload split into threads, that runs as a single benchmark.
+ * Benchmarks of a thread-count sweep share the DB, which stays open from the first one to the last.
+ */
+struct threads_workloads_t {
+    std::string name;
+    workloads_t workloads;
+    bool opens_db = true;
+    bool closes_db = true;
+};
 
+void bench(bm::State& state,
+           threads_workloads_t const& threads_workloads,
+           db_t& db,
+           settings_t const& settings,
+           threads_placement_t const& placement,
+           threads_fence_t& fence,
+           threads_stats_t& threads_stats) {
+
+    auto const& workload = threads_workloads.workloads[state.thread_index()];
+
+    // Note: Stats and roles must be prepared by all threads before anyone starts monitoring them
+    thread_role_guard_t role_guard(thread_role_t::worker_k);
+    threads_stats[state.thread_index()].clear();
+    for (auto const& phase : workload.phases) {
+        threads_stats[state.thread_index()].phases.emplace_back();
+        threads_stats[state.thread_index()].phases.back().prepare(phase.duration_s);
+    }
+    threads_stats[state.thread_index()].planned_operations = workload.operations_count;
+    threads_stats[state.thread_index()].group = workload.group_idx;
     if (state.thread_index() == 0) {
-        progress_t::print_db_open();
-        std::string error;
-        if (!db.open(error))
-            throw exception_t(error);
+        // Note: Workloads may run with fewer threads than the previous ones
+        for (size_t idx = state.threads(); idx < threads_stats.size(); ++idx)
+            threads_stats[idx].clear();
+        if (threads_workloads.opens_db) {
+            progress_t::print_db_open();
+            std::string error;
+            if (!db.open(error))
+                throw exception_t(error);
+        }
     }
     fence.sync();
 
-    if (transactional) {
+    if (settings.transactional) {
         auto transaction = db.create_transaction();
         if (!transaction)
             throw exception_t("Failed to create DB transaction");
-        bench(state, workload, db, *transaction);
+        bench(state, workload, db, *transaction, settings, placement, fence, threads_stats);
     }
     else
-        bench(state, workload, db, db);
+        bench(state, workload, db, db, settings, placement, fence, threads_stats);
 
     fence.sync();
-    if (state.thread_index() == 0) {
+    if (state.thread_index() == 0 && threads_workloads.closes_db) {
         progress_t::print_db_close();
         db.close();
         progress_t::clear_last_print();
@@ -515,6 +1146,7 @@ int main(int argc, char** argv) {
             final_results_file_path = fmt::format("{}/{}.json",
                                                   final_results_file_path.parent_path().string(),
                                                   settings.workloads_file_path.filename().stem().string());
+        settings.results_file_path = final_results_file_path;
         fs::path in_progress_results_file_path = fmt::format("{}/{}_in_progress.json",
                                                              final_results_file_path.parent_path().string(),
                                                              final_results_file_path.filename().stem().string());
@@ -539,6 +1171,13 @@ int main(int argc, char** argv) {
                 return 1;
             }
         }
+        if (!settings.trace_dir_path.empty() && !fs::exists(settings.trace_dir_path)) {
+            fs::create_directories(settings.trace_dir_path, ec);
+            if (ec) {
+                fmt::print("Failed to create traces directory. path: {}\n", settings.trace_dir_path.string());
+                return 1;
+            }
+        }
         for (auto const& dir_path : settings.db_storage_dir_paths) {
             if (!fs::exists(dir_path)) {
                 fs::create_directories(dir_path, ec);
@@ -564,11 +1203,25 @@ int main(int argc, char** argv) {
             fmt::print("Filter doesn't match any workload. filter: {}\n", settings.workload_filter);
             return 1;
         }
-        std::vector<workloads_t> threads_workloads;
+        // Note: Workloads with thread groups run with the threads of their groups, even in sweeps
+        std::vector<threads_workloads_t> benchmarks;
+        size_t max_threads_count = 0;
         for (auto const& workload : workloads) {
-            validate_workload(workload, settings.threads_count);
-            std::vector<workload_t> splitted_workloads = split_workload_into_threads(workload, settings.threads_count);
-            threads_workloads.push_back(splitted_workloads);
+            bool sweeps = !settings.threads_sweep.empty() && workload.groups.empty();
+            auto threads_counts = sweeps ? settings.threads_sweep : std::vector<size_t> {settings.threads_count};
+            for (size_t idx = 0; idx != threads_counts.size(); ++idx) {
+                validate_workload(workload, threads_counts[idx]);
+                threads_workloads_t benchmark;
+                benchmark.name = sweeps ? sweep_benchmark_name(workload.name, threads_counts[idx]) : workload.name;
+                benchmark.workloads = split_workload_into_threads(workload, threads_counts[idx]);
+                // Note: Time series and traces are named after the benchmark
+                for (auto& thread_workload : benchmark.workloads)
+                    thread_workload.name = benchmark.name;
+                benchmark.opens_db = idx == 0;
+                benchmark.closes_db = idx + 1 == threads_counts.size();
+                max_threads_count = std::max(max_threads_count, benchmark.workloads.size());
+                benchmarks.push_back(benchmark);
+            }
         }
 
         // Setup DB
@@ -579,21 +1232,46 @@ int main(int argc, char** argv) {
             return 1;
         }
         auto hints = make_hints(settings, workloads);
+        hints.threads_count = max_threads_count;
         db->set_config(settings.db_config_file_path, settings.db_main_dir_path, settings.db_storage_dir_paths, hints);
 
-        threads_fence_t fence(settings.threads_count);
+        if (settings.perf_counters && !perf_counters_t::available()) {
+            fmt::print("Hardware counters are unavailable (perf_event_paranoid: {}), skipping them\n",
+                       perf_counters_t::paranoid_level());
+            settings.perf_counters = false;
+        }
+
+        if (settings.huge_pages == huge_pages_t::hugetlb_k && reserved_huge_pages() == 0) {
+            fmt::print("No huge pages reserved (/proc/sys/vm/nr_hugepages), using transparent ones\n");
+            settings.huge_pages = huge_pages_t::transparent_k;
+        }
+        threads_placement_t placement(settings.pin_threads, settings.numa_bind, max_threads_count);
+        if (placement.oversubscribed())
+            fmt::print("More threads than CPUs to pin them to, some threads will share CPUs\n");
+        add_placement_context(settings, placement);
+        // Note: Passing it back with "--seed" reproduces the keys, values and operations of the run
+        bm::AddCustomContext("seed", std::to_string(settings.seed));
+
+        std::vector<std::unique_ptr<threads_fence_t>> fences;
+        threads_stats_t threads_stats(max_threads_count);
 
         // Register benchmarks
-        for (auto const& splitted_workloads : threads_workloads) {
-            std::string workload_name = splitted_workloads.front().name;
-            register_benchmark(workload_name, settings.threads_count, [&](bm::State& state) {
-                auto const& workload = splitted_workloads[state.thread_index()];
-                bench(state, workload, *db, settings.transactional, fence);
+        for (auto const& benchmark : benchmarks) {
+            fences.push_back(std::make_unique<threads_fence_t>(benchmark.workloads.size()));
+            threads_fence_t* fence = fences.back().get();
+            register_benchmark(benchmark.name, benchmark.workloads.size(), [&, fence](bm::State& state) {
+                bench(state, benchmark, *db, settings, placement, *fence, threads_stats);
             });
         }
 
         std::string title = build_title(settings, workloads, db->info());
-        run(argc, argv, title, settings.run_idx, settings.runs_count, in_progress_results_file_path);
+        run(argc,
+            argv,
+            title,
+            settings.run_idx,
+            settings.runs_count,
+            in_progress_results_file_path,
+            settings.ceiling_results_file_path);
 
         file_reporter_t::merge_results(in_progress_results_file_path, final_results_file_path);
         fs::remove(in_progress_results_file_path);
@@ -1,46 +1,67 @@
 #pragma once
 
+#include <sys/mman.h>
+#include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <utility>
 
 namespace ucsb {
 
+/**
+ * @brief Pages backing a buffer. Huge pages save TLB misses on large buffers.
+ */
+enum class huge_pages_t {
+    none_k = 0,
+    // Transparent huge pages, if the kernel manages to find them
+    transparent_k,
+    // Pages from the pool reserved in "/proc/sys/vm/nr_hugepages"
+    hugetlb_k,
+};
+
 /**
  * @brief Aligned buffer for direct file I/O
  */
 class aligned_buffer_t {
   public:
     constexpr static size_t alignment_k = 4096;
+    // Note: The default huge page size on x86 and on ARM with 4KB base pages
+    constexpr static size_t huge_page_size_k = 2 * 1024 * 1024;
 
-    inline aligned_buffer_t() noexcept : buffer_(nullptr), size_(0) {}
-    inline aligned_buffer_t(size_t size) : buffer_(nullptr), size_(size) {
+    inline aligned_buffer_t() noexcept
+        : buffer_(nullptr), size_(0), capacity_(0), huge_pages_(huge_pages_t::none_k), mapped_(false) {}
+    inline aligned_buffer_t(size_t size, huge_pages_t huge_pages = huge_pages_t::none_k)
+        : buffer_(nullptr), size_(size), capacity_(size), huge_pages_(huge_pages), mapped_(false) {
         assert(size % alignment_k == 0);
-        buffer_ = reinterpret_cast<std::byte*>(std::aligned_alloc(alignment_k, size));
+        allocate();
     }
 
-    inline aligned_buffer_t(aligned_buffer_t const& other) : aligned_buffer_t(other.size_) {
+    inline aligned_buffer_t(aligned_buffer_t const& other) : aligned_buffer_t(other.size_, other.huge_pages_) {
         memcpy(buffer_, other.buffer_, size_);
     }
     inline aligned_buffer_t(aligned_buffer_t&& other) noexcept
-        : buffer_(std::move(other.buffer_)), size_(std::move(other.size_)) {
+        : buffer_(std::move(other.buffer_)), size_(std::move(other.size_)), capacity_(other.capacity_),
+          huge_pages_(other.huge_pages_), mapped_(other.mapped_) {
         other.buffer_ = nullptr;
         other.size_ = 0;
+        other.capacity_ = 0;
+        other.mapped_ = false;
     }
 
-    ~aligned_buffer_t() { std::free(buffer_); }
+    ~aligned_buffer_t() { deallocate(); }
 
     inline aligned_buffer_t operator=(aligned_buffer_t const& other) {
         aligned_buffer_t copy(other);
-        std::swap(buffer_, copy.buffer_);
-        std::swap(size_, copy.size_);
+        swap(copy);
         return *this;
     }
     inline aligned_buffer_t operator=(aligned_buffer_t&& other) {
-        std::swap(buffer_, other.buffer_);
-        std::swap(size_, other.size_);
+        swap(other);
         return *this;
     }
 
     inline size_t size() const noexcept { return size_; }
+    inline huge_pages_t huge_pages() const noexcept { return huge_pages_; }
 
     inline std::byte& operator[](size_t idx) noexcept { return buffer_[idx]; }
     inline std::byte const& operator[](size_t idx) const noexcept { return buffer_[idx]; }
@@ -49,8 +70,53 @@ class aligned_buffer_t {
     inline std::byte const* data() const noexcept { return buffer_; }
 
   private:
+    inline void allocate() {
+        if (huge_pages_ == huge_pages_t::none_k || size_ == 0) {
+            buffer_ = reinterpret_cast<std::byte*>(std::aligned_alloc(alignment_k, size_));
+            return;
+        }
+
+        capacity_ = (size_ + huge_page_size_k - 1) / huge_page_size_k * huge_page_size_k;
+        if (huge_pages_ == huge_pages_t::hugetlb_k) {
+            void* buffer = mmap(nullptr,
+                                capacity_,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                                -1,
+                                0);
+            if (buffer != MAP_FAILED) {
+                buffer_ = reinterpret_cast<std::byte*>(buffer);
+                mapped_ = true;
+                return;
+            }
+            // Note: Falls back to transparent huge pages, once the reserved pool is exhausted
+        }
+
+        buffer_ = reinterpret_cast<std::byte*>(std::aligned_alloc(huge_page_size_k, capacity_));
+        if (buffer_)
+            madvise(buffer_, capacity_, MADV_HUGEPAGE);
+    }
+
+    inline void deallocate() noexcept {
+        if (mapped_)
+            munmap(buffer_, capacity_);
+        else
+            std::free(buffer_);
+    }
+
+    inline void swap(aligned_buffer_t& other) noexcept {
+        std::swap(buffer_, other.buffer_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(huge_pages_, other.huge_pages_);
+        std::swap(mapped_, other.mapped_);
+    }
+
     std::byte* buffer_;
     size_t size_;
+    size_t capacity_;
+    huge_pages_t huge_pages_;
+    bool mapped_;
 };
 
-} // namespace ucsb
\ No newline at end of file
+} // namespace ucsb
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+
+#include "src/core/helper.hpp"
+
+#ifndef UCSB_COUNT_ALLOCATIONS
+#define UCSB_COUNT_ALLOCATIONS 0
+#endif
+
+namespace ucsb {
+
+/**
+ * @brief Whether this build interposes `malloc` & co. to count heap allocations.
+ * Enabled by the `UCSB_COUNT_ALLOCATIONS` CMake option, as it slows down every allocation.
+ */
+constexpr bool allocations_counted_k = UCSB_COUNT_ALLOCATIONS;
+
+struct allocations_t {
+    size_t count = 0;
+    size_t bytes = 0;
+
+    inline allocations_t operator-(allocations_t const& older) const noexcept {
+        return {count - older.count, bytes - older.bytes};
+    }
+
+    // Note: Only the owning thread may call it
+    inline void add(allocations_t const& other) noexcept {
+        atomic_store(count, count + other.count);
+        atomic_store(bytes, bytes + other.bytes);
+    }
+
+    inline void merge(allocations_t const& other) noexcept {
+        count += atomic_load(other.count);
+        bytes += atomic_load(other.bytes);
+    }
+
+    inline void subtract(allocations_t const& older) noexcept {
+        count -= older.count;
+        bytes -= older.bytes;
+    }
+};
+
+/**
+ * @brief Allocations made by the calling thread since it started.
+ * Stays zero, unless allocations are counted.
+ */
+inline allocations_t& thread_allocations() noexcept {
+    // Note: Constant-initialized, so it's safe to access from within `malloc`
+    static thread_local allocations_t allocations;
+    return allocations;
+}
+
+} // namespace ucsb
+
+#if UCSB_COUNT_ALLOCATIONS
+
+// Note: `operator new` and most of the libraries end up here, this is glibc-specific
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t size) noexcept {
+    ucsb::thread_allocations().count++;
+    ucsb::thread_allocations().bytes += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    ucsb::thread_allocations().count++;
+    ucsb::thread_allocations().bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+    ucsb::thread_allocations().count++;
+    ucsb::thread_allocations().bytes += size;
+    return __libc_realloc(pointer, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    ucsb::thread_allocations().count++;
+    ucsb::thread_allocations().bytes += size;
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept { return memalign(alignment, size); }
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    *pointer = memalign(alignment, size);
+    return *pointer ? 0 : ENOMEM;
+}
+
+void free(void* pointer) noexcept { __libc_free(pointer); }
+}
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <span>
+#include <cstddef>
+
+#include "src/core/types.hpp"
+#include "src/core/operation.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief A single operation submitted to an `async_queue_t`.
+ * The submitter owns the request and all the memory its spans point to,
+ * and keeps both intact until the request is polled back as completed.
+ */
+struct async_request_t {
+    operation_kind_t operation = operation_kind_t::read_k;
+    /**
+     * @brief A single key for most operations, the batch for batch operations,
+     * or the first key of the range for range selects and scans.
+     */
+    keys_spanc_t keys;
+    // Values to write, continuous, and their lengths, one per key
+    values_spanc_t values;
+    value_lengths_spanc_t value_lengths;
+    // A buffer to read values into, big enough for all of them
+    values_span_t buffer;
+    // The number of entries of range selects and scans
+    size_t length = 0;
+
+    operation_result_t result;
+    // Note: Isn't touched by the queue, submitters use it to find their state
+    size_t tag = 0;
+};
+
+/**
+ * @brief Keeps many operations of a single thread in flight at once.
+ * Created per thread by `data_accessor_t::create_async_queue`, so implementations
+ * don't have to be thread-safe. Engines with asynchronous or batched interfaces
+ * should provide their own implementation, like submitting requests to io_uring
+ * or pipelining them, while the default one executes them synchronously.
+ */
+class async_queue_t {
+  public:
+    virtual ~async_queue_t() {}
+
+    /**
+     * @brief The maximum number of requests in flight, requested on creation.
+     */
+    virtual size_t depth() const noexcept = 0;
+    virtual size_t in_flight() const noexcept = 0;
+
+    /**
+     * @brief Starts the request. Must be called only while fewer than `depth()` are in flight.
+     */
+    virtual void submit(async_request_t& request) = 0;
+
+    /**
+     * @brief Collects completed requests.
+     * @param wait Whether to wait for at least one, if any are in flight.
+     * @return The number of requests written into `completed`.
+     */
+    virtual size_t poll(std::span<async_request_t*> completed, bool wait) = 0;
+};
+
+} // namespace ucsb
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <set>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "src/core/types.hpp"
 #include "src/core/operation.hpp"
+#include "src/core/async.hpp"
 
 namespace ucsb {
 
@@ -86,6 +90,74 @@ class data_accessor_t {
      * @param values A temporary buffer big enough for a all values.
      */
     virtual operation_result_t scan(key_t key, size_t length, value_span_t single_value) const = 0;
+
+    /**
+     * @brief Creates a queue for the calling thread to keep up to `depth` operations in flight.
+     * By default operations are executed synchronously on submission, so they just wait
+     * in the queue to be polled, which emulates a client queueing requests to a blocking engine.
+     */
+    virtual std::unique_ptr<async_queue_t> create_async_queue(size_t depth);
+};
+
+/**
+ * @brief Executes the request with the synchronous interface.
+ */
+inline operation_result_t execute(data_accessor_t& data_accessor, async_request_t const& request) {
+    switch (request.operation) {
+    case operation_kind_t::upsert_k:
+        return data_accessor.upsert(request.keys.front(), value_spanc_t(request.values));
+    case operation_kind_t::update_k:
+        return data_accessor.update(request.keys.front(), value_spanc_t(request.values));
+    case operation_kind_t::remove_k: return data_accessor.remove(request.keys.front());
+    case operation_kind_t::read_k: return data_accessor.read(request.keys.front(), request.buffer);
+    case operation_kind_t::read_modify_write_k:
+        data_accessor.read(request.keys.front(), request.buffer);
+        return data_accessor.update(request.keys.front(), value_spanc_t(request.values));
+    case operation_kind_t::batch_upsert_k:
+        return data_accessor.batch_upsert(request.keys, request.values, request.value_lengths);
+    case operation_kind_t::batch_read_k: return data_accessor.batch_read(request.keys, request.buffer);
+    case operation_kind_t::bulk_load_k:
+        return data_accessor.bulk_load(request.keys, request.values, request.value_lengths);
+    case operation_kind_t::range_select_k:
+        return data_accessor.range_select(request.keys.front(), request.length, request.buffer);
+    case operation_kind_t::scan_k: return data_accessor.scan(request.keys.front(), request.length, request.buffer);
+    default: return {0, operation_status_t::not_implemented_k};
+    }
+}
+
+/**
+ * @brief The default queue, executing requests right on submission.
+ */
+class sync_async_queue_t : public async_queue_t {
+  public:
+    inline sync_async_queue_t(data_accessor_t& data_accessor, size_t depth)
+        : data_accessor_(&data_accessor), depth_(depth) {
+        completed_.reserve(depth);
+    }
+
+    size_t depth() const noexcept override { return depth_; }
+    size_t in_flight() const noexcept override { return completed_.size(); }
+
+    void submit(async_request_t& request) override {
+        request.result = execute(*data_accessor_, request);
+        completed_.push_back(&request);
+    }
+
+    size_t poll(std::span<async_request_t*> completed, bool) override {
+        size_t count = std::min(completed.size(), completed_.size());
+        std::copy(completed_.begin(), completed_.begin() + count, completed.begin());
+        completed_.erase(completed_.begin(), completed_.begin() + count);
+        return count;
+    }
+
+  private:
+    data_accessor_t* data_accessor_;
+    size_t depth_;
+    std::vector<async_request_t*> completed_;
 };
 
+inline std::unique_ptr<async_queue_t> data_accessor_t::create_async_queue(size_t depth) {
+    return std::make_unique<sync_async_queue_t>(*this, depth);
+}
+
 } // namespace ucsb
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "src/core/types.hpp"
 #include "src/core/db.hpp"
+#include "src/null/null.hpp"
 
 #if defined(UCSB_HAS_USTORE)
 #include "src/ustore/ustore.hpp"
@@ -41,6 +42,8 @@ enum class db_brand_t {
     redis_k,
     lmdb_k,
     haura_k,
+    null_k,
+    echo_k,
 };
 
 std::shared_ptr<db_t> make_db(db_brand_t db_brand, bool transactional) {
@@ -52,6 +55,8 @@ std::shared_ptr<db_t> make_db(db_brand_t db_brand, bool transactional) {
 #if defined(UCSB_HAS_ROCKSDB)
         case db_brand_t::rocksdb_k: return std::make_shared<facebook::rocksdb_t>(facebook::db_mode_t::transactional_k);
 #endif
+        case db_brand_t::null_k: return std::make_shared<null::null_t>();
+        case db_brand_t::echo_k: return std::make_shared<null::echo_t>();
         default: break;
         }
     }
@@ -81,6 +86,8 @@ std::shared_ptr<db_t> make_db(db_brand_t db_brand, bool transactional) {
 #if defined(UCSB_HAS_HAURA)
         case db_brand_t::haura_k: return std::make_shared<haura::hauradb_t>();
 #endif
+        case db_brand_t::null_k: return std::make_shared<null::null_t>();
+        case db_brand_t::echo_k: return std::make_shared<null::echo_t>();
         default: break;
         }
     }
@@ -104,6 +111,10 @@ inline db_brand_t parse_db_brand(std::string const& name) {
         return db_brand_t::lmdb_k;
     if (name == "haura")
         return db_brand_t::haura_k;
+    if (name == "null")
+        return db_brand_t::null_k;
+    if (name == "echo")
+        return db_brand_t::echo_k;
     return db_brand_t::unknown_k;
 }
 
@@ -12,6 +12,10 @@ enum class distribution_kind_t {
     scrambled_zipfian_k,
     skewed_latest_k,
     acknowledged_counter_k,
+    replay_k,
+    hotspot_k,
+    exponential_k,
+    sequential_k,
 };
 
 } // namespace ucsb
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <random>
+#include <algorithm>
 
 #include "src/core/generators/generator.hpp"
 
@@ -15,6 +15,7 @@ class const_generator_gt : public generator_gt<value_at> {
 
     inline value_t generate() override { return constant_; }
     inline value_t last() override { return constant_; }
+    inline void fill(std::span<value_t> values) override { std::fill(values.begin(), values.end(), constant_); }
 
   private:
     value_t constant_;
@@ -12,6 +12,10 @@ class counter_generator_t : public generator_gt<size_t> {
 
     inline size_t generate() override { return counter_++; }
     inline size_t last() override { return counter_ - 1; }
+    inline void fill(std::span<size_t> values) override {
+        for (auto& value : values)
+            value = counter_++;
+    }
 
   protected:
     size_t counter_;
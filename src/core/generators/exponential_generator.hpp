@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cmath>
+#include <cassert>
+
+#include "src/core/generators/counter_generator.hpp"
+#include "src/core/generators/rng.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief Same as YCSB's "exponential" distribution: favors the most recently inserted keys,
+ * with popularity decaying exponentially with age, like in time-series.
+ * `percentile` percent of accesses fall within the latest `range` keys.
+ */
+class exponential_generator_t : public generator_gt<size_t> {
+  public:
+    inline exponential_generator_t(
+        counter_generator_t& counter, size_t min, double percentile, double range, xoshiro256ss_t rng)
+        : basis_(&counter), rand_(rng), min_(min), gamma_(-std::log1p(-percentile / 100) / range) {
+        assert(percentile > 0 && percentile < 100 && range > 0);
+        generate();
+    }
+
+    inline size_t generate() override;
+    inline size_t last() override { return last_; }
+
+  private:
+    counter_generator_t* basis_;
+    xoshiro256ss_t rand_;
+    size_t min_;
+    double gamma_;
+    size_t last_ = 0;
+};
+
+inline size_t exponential_generator_t::generate() {
+    size_t max = basis_->last();
+    // Note: Redraws ages older than the first key, same as YCSB
+    double age = 0;
+    do {
+        age = std::floor(-std::log1p(-rand_.next_double()) / gamma_);
+    } while (age > double(max - min_));
+    return last_ = max - size_t(age);
+}
+
+} // namespace ucsb::core
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "src/core/types.hpp"
 
 namespace ucsb::core {
@@ -13,6 +15,15 @@ class generator_gt {
 
     virtual value_t generate() = 0;
     virtual value_t last() = 0;
+
+    /**
+     * @brief Generates a whole batch with a single virtual call.
+     * Generators override it, when they can do it faster than one by one.
+     */
+    virtual void fill(std::span<value_t> values) {
+        for (auto& value : values)
+            value = generate();
+    }
 };
 
-} // namespace ucsb::core
\ No newline at end of file
+} // namespace ucsb::core
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <span>
+#include <cassert>
+#include <algorithm>
+
+#include "src/core/generators/generator.hpp"
+#include "src/core/generators/rng.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief Same as YCSB's "hotspot" distribution: the first `hot_keys_fraction` of the range is the hot set,
+ * receiving `hot_operations_fraction` of accesses, while both sets are accessed uniformly within.
+ */
+class hotspot_generator_t : public generator_gt<size_t> {
+  public:
+    inline hotspot_generator_t(
+        size_t min, size_t max, double hot_keys_fraction, double hot_operations_fraction, xoshiro256ss_t rng)
+        : rand_(rng), min_(min), hot_operations_fraction_(hot_operations_fraction) {
+        assert(max >= min);
+        assert(hot_keys_fraction >= 0 && hot_keys_fraction <= 1);
+        assert(hot_operations_fraction >= 0 && hot_operations_fraction <= 1);
+        size_t items_count = max - min + 1;
+        hot_count_ = std::clamp(size_t(items_count * hot_keys_fraction), size_t(1), items_count);
+        cold_count_ = items_count - hot_count_;
+        generate();
+    }
+
+    inline size_t generate() override { return last_ = draw(); }
+    inline size_t last() override { return last_; }
+    inline void fill(std::span<size_t> values) override {
+        for (auto& value : values)
+            value = draw();
+        if (!values.empty())
+            last_ = values.back();
+    }
+
+  private:
+    inline size_t draw() noexcept {
+        if (!cold_count_ || rand_.next_double() < hot_operations_fraction_)
+            return min_ + rand_.next_below(hot_count_);
+        return min_ + hot_count_ + rand_.next_below(cold_count_);
+    }
+
+    xoshiro256ss_t rand_;
+    size_t min_;
+    size_t hot_count_;
+    size_t cold_count_;
+    double hot_operations_fraction_;
+    size_t last_ = 0;
+};
+
+} // namespace ucsb::core
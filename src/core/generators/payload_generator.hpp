@@ -0,0 +1,62 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <cstddef>
+
+#include "src/core/types.hpp"
+#include "src/core/generators/rng.hpp"
+#include "src/core/generators/random_generator.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief Generates value payloads by copying them out of a pool of random bytes, generated once.
+ * Every value starts at an offset derived from its key and a rotating counter, so rewrites
+ * of the same key differ, and generation is just a `memcpy`, which libc already vectorizes
+ * with the widest instructions available, running at memory bandwidth.
+ * Note: Same as in LevelDB's "db_bench", the pool is large enough to keep compressors from
+ * finding repeats within a block, but values of a large dataset do share their bytes.
+ */
+class payload_generator_t {
+  public:
+    static constexpr size_t pool_size_k = 1024 * 1024;
+    static constexpr size_t piece_size_k = 100;
+
+    /**
+     * @param compression_ratio The target compressed to raw size ratio of payloads.
+     * Same as in "db_bench", the pool is built of pieces, each repeating a random prefix
+     * of this share of the piece, so LZ-style compressors like Snappy, LZ4 or Zstd
+     * shrink it to about that ratio, while 1 keeps the whole pool random.
+     */
+    inline payload_generator_t(value_length_t max_length, double compression_ratio, xoshiro256ss_t rng)
+        : pool_(pool_size_k + max_length) {
+        random_byte_generator_t bytes(rng);
+        size_t random_size = std::clamp(size_t(compression_ratio * piece_size_k), size_t(1), piece_size_k);
+        for (size_t offset = 0; offset < pool_.size(); offset += piece_size_k) {
+            size_t piece_size = std::min(piece_size_k, pool_.size() - offset);
+            char* piece = pool_.data() + offset;
+            bytes.fill(std::span<char>(piece, std::min(random_size, piece_size)));
+            for (size_t idx = random_size; idx < piece_size; ++idx)
+                piece[idx] = piece[idx - random_size];
+        }
+    }
+
+    inline void fill(key_t key, std::span<std::byte> value) noexcept {
+        std::memcpy(value.data(), pool_.data() + offset(key), value.size());
+    }
+
+  private:
+    inline size_t offset(key_t key) noexcept {
+        // Note: Fibonacci hashing spreads consecutive keys, the counter moves rewrites
+        uint64_t mixed = (uint64_t(key) ^ (counter_++ << 32)) * 0x9E3779B97F4A7C15ull;
+        return size_t(mixed >> 32) % pool_size_k;
+    }
+
+    std::vector<char> pool_;
+    uint64_t counter_ = 0;
+};
+
+} // namespace ucsb::core
@@ -1,51 +1,62 @@
 #pragma once
 
-#include <random>
+#include <span>
 
 #include "src/core/generators/generator.hpp"
+#include "src/core/generators/rng.hpp"
 
 namespace ucsb::core {
 
 class random_int_generator_t final : public generator_gt<uint32_t> {
   public:
-    inline random_int_generator_t() : device_(), rand_(device_()), last_(0) { generate(); }
+    inline random_int_generator_t(xoshiro256ss_t rng) : rand_(rng), last_(0) { generate(); }
 
-    inline uint32_t generate() override { return last_ = rand_(); }
+    inline uint32_t generate() override { return last_ = uint32_t(rand_() >> 32); }
     inline uint32_t last() override { return last_; }
 
   private:
-    std::random_device device_;
-    std::minstd_rand rand_;
-    float last_;
+    xoshiro256ss_t rand_;
+    uint32_t last_;
 };
 
 class random_double_generator_t final : public generator_gt<float> {
   public:
-    inline random_double_generator_t(float min, float max)
-        : device_(), rand_(device_()), uniform_(min, max), last_(0.0) {
+    inline random_double_generator_t(float min, float max, xoshiro256ss_t rng)
+        : rand_(rng), min_(min), range_(max - min), last_(0.0) {
         generate();
     }
     ~random_double_generator_t() override = default;
 
-    inline float generate() override { return last_ = uniform_(rand_); }
+    // Note: Takes 24 bits, as rounding a double just below 1 to float would give exactly 1
+    inline float generate() override { return last_ = min_ + range_ * (float(rand_() >> 40) * 0x1.0p-24f); }
     inline float last() override { return last_; }
 
   private:
-    std::random_device device_;
-    std::minstd_rand rand_;
-    std::uniform_real_distribution<float> uniform_;
+    xoshiro256ss_t rand_;
+    float min_;
+    float range_;
     float last_;
 };
 
 class random_byte_generator_t final : public generator_gt<char> {
   public:
-    inline random_byte_generator_t() : off_(6) {}
+    inline random_byte_generator_t(xoshiro256ss_t rng) : generator_(rng), off_(6) {}
     ~random_byte_generator_t() override = default;
 
     inline char generate() override;
     inline char last() override { return buf_[(off_ - 1 + 6) % 6]; }
+    inline void fill(std::span<char> values) override;
 
   private:
+    static inline void expand(uint32_t bytes, char* buf) noexcept {
+        buf[0] = static_cast<char>((bytes & 31) + ' ');
+        buf[1] = static_cast<char>(((bytes >> 5) & 63) + ' ');
+        buf[2] = static_cast<char>(((bytes >> 10) & 95) + ' ');
+        buf[3] = static_cast<char>(((bytes >> 15) & 31) + ' ');
+        buf[4] = static_cast<char>(((bytes >> 20) & 63) + ' ');
+        buf[5] = static_cast<char>(((bytes >> 25) & 95) + ' ');
+    }
+
     random_int_generator_t generator_;
     char buf_[6];
     int off_;
@@ -53,17 +64,20 @@ class random_byte_generator_t final : public generator_gt<char> {
 
 inline char random_byte_generator_t::generate() {
     if (off_ == 6) {
-        uint32_t bytes = generator_.generate();
-        buf_[0] = static_cast<char>((bytes & 31) + ' ');
-        buf_[1] = static_cast<char>(((bytes >> 5) & 63) + ' ');
-        buf_[2] = static_cast<char>(((bytes >> 10) & 95) + ' ');
-        buf_[3] = static_cast<char>(((bytes >> 15) & 31) + ' ');
-        buf_[4] = static_cast<char>(((bytes >> 20) & 63) + ' ');
-        buf_[5] = static_cast<char>(((bytes >> 25) & 95) + ' ');
+        expand(generator_.generate(), buf_);
         off_ = 0;
     }
 
     return buf_[off_++];
 }
 
-} // namespace ucsb::core
\ No newline at end of file
+inline void random_byte_generator_t::fill(std::span<char> values) {
+    // Note: Expands whole words straight into the output, leaving the tail to `generate()`
+    size_t idx = 0;
+    for (; idx + 6 <= values.size(); idx += 6)
+        expand(generator_.generate(), values.data() + idx);
+    for (; idx != values.size(); ++idx)
+        values[idx] = generate();
+}
+
+} // namespace ucsb::core
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace ucsb::core {
+
+/**
+ * @brief SplitMix64, used only to expand a single 64-bit seed into the state of `xoshiro256ss_t`,
+ * as recommended by its authors, so that even similar seeds give unrelated states.
+ */
+class splitmix64_t {
+  public:
+    inline splitmix64_t(uint64_t seed) noexcept : state_(seed) {}
+
+    inline uint64_t operator()() noexcept {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+  private:
+    uint64_t state_;
+};
+
+/**
+ * @brief xoshiro256** by David Blackman and Sebastiano Vigna.
+ * 256 bits of state, a period of 2^256 - 1 and a few cycles per 64-bit value.
+ * Satisfies `UniformRandomBitGenerator`, so it also works with the standard distributions.
+ *
+ * @see https://prng.di.unimi.it
+ */
+class xoshiro256ss_t {
+  public:
+    using result_type = uint64_t;
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    inline xoshiro256ss_t(uint64_t seed) noexcept {
+        splitmix64_t expander(seed);
+        for (auto& word : state_)
+            word = expander();
+    }
+
+    inline result_type operator()() noexcept {
+        uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief A uniform double in [0, 1), from the upper 53 bits.
+     */
+    inline double next_double() noexcept { return ((*this)() >> 11) * 0x1.0p-53; }
+
+    /**
+     * @brief A uniform integer in [0, bound), using Lemire's multiply-shift reduction.
+     * Note: Biased by at most `bound / 2^64`, which is negligible for key spaces.
+     */
+    inline uint64_t next_below(uint64_t bound) noexcept {
+        return uint64_t((static_cast<unsigned __int128>((*this)()) * bound) >> 64);
+    }
+
+    inline void fill(std::span<uint64_t> values) noexcept {
+        for (auto& value : values)
+            value = (*this)();
+    }
+
+    /**
+     * @brief Advances by 2^128 values, to split the sequence into streams for generators.
+     */
+    inline void jump() noexcept {
+        advance({0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull});
+    }
+    /**
+     * @brief Advances by 2^192 values, to split the sequence into streams for threads.
+     */
+    inline void long_jump() noexcept {
+        advance({0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull});
+    }
+
+  private:
+    static inline uint64_t rotl(uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+    inline void advance(std::array<uint64_t, 4> const& polynomial) noexcept {
+        std::array<uint64_t, 4> state {};
+        for (uint64_t word : polynomial)
+            for (int bit = 0; bit != 64; ++bit) {
+                if (word & (uint64_t(1) << bit))
+                    for (size_t idx = 0; idx != state.size(); ++idx)
+                        state[idx] ^= state_[idx];
+                (*this)();
+            }
+        state_ = state;
+    }
+
+    std::array<uint64_t, 4> state_;
+};
+
+/**
+ * @brief Hands out independent random streams to the generators of a single thread.
+ * All of them derive from a single seed: every thread starts 2^192 values after the
+ * previous one, and every generator of a thread 2^128 values after the previous one.
+ * So, as long as generators are created in the same order, runs with the same seed
+ * draw the same sequences, no matter how threads are scheduled.
+ */
+class random_streams_t {
+  public:
+    inline random_streams_t(uint64_t seed, size_t thread_idx) noexcept : next_(seed) {
+        for (size_t idx = 0; idx != thread_idx; ++idx)
+            next_.long_jump();
+    }
+
+    inline xoshiro256ss_t next() noexcept {
+        xoshiro256ss_t stream = next_;
+        next_.jump();
+        return stream;
+    }
+
+  private:
+    xoshiro256ss_t next_;
+};
+
+} // namespace ucsb::core
@@ -1,26 +1,34 @@
 #pragma once
 
+#include <span>
 #include <cassert>
 
 #include "src/core/generators/zipfian_generator.hpp"
 
 namespace ucsb::core {
 
+/**
+ * @brief Zipfian distribution, with popular items scattered all over the key space by hashing their ranks.
+ */
 class scrambled_zipfian_generator_t : public generator_gt<size_t> {
   public:
-    inline scrambled_zipfian_generator_t(size_t min, size_t max, float zipfian_const)
-        : base_(min), num_items_(max - min + 1), generator_(0, 10'000'000'000LL, zipfian_const) {}
-    inline scrambled_zipfian_generator_t(size_t min, size_t max)
-        : base_(min), num_items_(max - min + 1),
-          generator_(0, 10'000'000'000LL, zipfian_generator_t::zipfian_const_k, zetan_k) {}
-    inline scrambled_zipfian_generator_t(size_t num_items) : scrambled_zipfian_generator_t(0, num_items - 1) {}
+    inline scrambled_zipfian_generator_t(size_t min,
+                                         size_t max,
+                                         xoshiro256ss_t rng,
+                                         double theta = zipfian_generator_t::zipfian_const_k)
+        : base_(min), num_items_(max - min + 1), generator_(num_items_, rng, theta) {}
+    inline scrambled_zipfian_generator_t(size_t num_items, xoshiro256ss_t rng)
+        : scrambled_zipfian_generator_t(0, num_items - 1, rng) {}
 
     inline size_t generate() override { return scramble(generator_.generate()); }
     inline size_t last() override { return scramble(generator_.last()); }
+    inline void fill(std::span<size_t> values) override {
+        generator_.fill(values);
+        for (auto& value : values)
+            value = scramble(value);
+    }
 
   private:
-    static constexpr float zetan_k = 26.46902820178302;
-
     inline size_t scramble(size_t value) const noexcept { return base_ + fnv_hash64(value) % num_items_; }
 
     inline size_t fnv_hash64(size_t val) const noexcept {
@@ -42,4 +50,4 @@ class scrambled_zipfian_generator_t : public generator_gt<size_t> {
     zipfian_generator_t generator_;
 };
 
-} // namespace ucsb::core
\ No newline at end of file
+} // namespace ucsb::core
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <span>
+#include <cassert>
+#include <algorithm>
+
+#include "src/core/generators/generator.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief Walks the range in steps of `stride`, wrapping around at its end.
+ * Every wrap starts from the next offset within the stride, so whatever the stride,
+ * every key is visited exactly once in `max - min + 1` draws, before the walk repeats.
+ */
+class sequential_generator_t : public generator_gt<size_t> {
+  public:
+    inline sequential_generator_t(size_t min, size_t max, size_t stride)
+        : min_(min), items_count_(max - min + 1), stride_(std::min(stride, items_count_)), last_(min) {
+        assert(max >= min && stride > 0);
+    }
+
+    inline size_t generate() override { return last_ = min_ + draw(); }
+    inline size_t last() override { return last_; }
+    inline void fill(std::span<size_t> values) override {
+        for (auto& value : values)
+            value = min_ + draw();
+        if (!values.empty())
+            last_ = values.back();
+    }
+
+  private:
+    inline size_t draw() noexcept {
+        size_t position = position_;
+        position_ += stride_;
+        if (position_ >= items_count_) {
+            lane_ = (lane_ + 1) % stride_;
+            position_ = lane_;
+        }
+        return position;
+    }
+
+    size_t min_;
+    size_t items_count_;
+    size_t stride_;
+    size_t position_ = 0;
+    size_t lane_ = 0;
+    size_t last_;
+};
+
+} // namespace ucsb::core
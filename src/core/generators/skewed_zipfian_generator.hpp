@@ -9,7 +9,12 @@ namespace ucsb::core {
 
 class skewed_latest_generator_t : public generator_gt<size_t> {
   public:
-    skewed_latest_generator_t(counter_generator_t& counter) : basis_(&counter), zipfian_(basis_->last()) { generate(); }
+    skewed_latest_generator_t(counter_generator_t& counter,
+                              xoshiro256ss_t rng,
+                              double theta = zipfian_generator_t::zipfian_const_k)
+        : basis_(&counter), zipfian_(basis_->last(), rng, theta) {
+        generate();
+    }
 
     inline size_t generate() override;
     inline size_t last() override { return last_; }
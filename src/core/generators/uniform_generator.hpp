@@ -1,8 +1,10 @@
 #pragma once
 
-#include <random>
+#include <span>
+#include <type_traits>
 
 #include "src/core/generators/generator.hpp"
+#include "src/core/generators/rng.hpp"
 
 namespace ucsb::core {
 
@@ -12,14 +14,27 @@ class uniform_generator_gt : public generator_gt<value_at> {
     using value_t = value_at;
     static_assert(std::is_integral<value_t>());
 
-    inline uniform_generator_gt(value_t min, value_t max) : dist_(min, max), last_(0) { generate(); }
-    inline value_t generate() override { return last_ = dist_(generator_); }
+    inline uniform_generator_gt(value_t min, value_t max, xoshiro256ss_t rng)
+        : rand_(rng), min_(min), range_(uint64_t(max - min) + 1), last_(0) {
+        generate();
+    }
+    inline value_t generate() override { return last_ = draw(); }
     inline value_t last() override { return last_; }
+    inline void fill(std::span<value_t> values) override {
+        for (auto& value : values)
+            value = draw();
+        if (!values.empty())
+            last_ = values.back();
+    }
 
   private:
-    std::mt19937_64 generator_;
-    std::uniform_int_distribution<value_t> dist_;
+    // Note: A zero range means the whole 64-bit space
+    inline value_t draw() noexcept { return value_t(min_ + (range_ ? rand_.next_below(range_) : rand_())); }
+
+    xoshiro256ss_t rand_;
+    value_t min_;
+    uint64_t range_;
     value_t last_;
 };
 
-} // namespace ucsb::core
\ No newline at end of file
+} // namespace ucsb::core
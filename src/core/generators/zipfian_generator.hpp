@@ -1,88 +1,130 @@
 #pragma once
 
-#include <random>
+#include <span>
+#include <cmath>
 #include <cassert>
+#include <algorithm>
 
 #include "src/core/generators/generator.hpp"
-#include "src/core/generators/random_generator.hpp"
+#include "src/core/generators/rng.hpp"
 
 namespace ucsb::core {
 
+/**
+ * @brief Draws ranks with probabilities proportional to `1 / rank^theta`, the most popular first.
+ * Uses the rejection-inversion method, which needs neither the zeta constant, nor any tables,
+ * so it is constructed in O(1) for any number of items, and draws in O(1) expected time,
+ * with under 1.1 attempts on average, all in double precision.
+ *
+ * @see "Rejection-inversion to generate variates from monotone discrete distributions"
+ * by Wolfgang Hörmann and Gerhard Derflinger, 1996.
+ */
 class zipfian_generator_t : public generator_gt<size_t> {
   public:
-    static constexpr float zipfian_const_k = 0.99;
-    static constexpr size_t items_max_count = (UINT64_MAX >> 24);
+    static constexpr double zipfian_const_k = 0.99;
 
-    zipfian_generator_t(size_t items_count) : zipfian_generator_t(0, items_count - 1) {}
-    zipfian_generator_t(size_t min, size_t max, float zipfian_const = zipfian_const_k)
-        : zipfian_generator_t(min, max, zipfian_const, zeta(max - min + 1, zipfian_const)) {}
-    zipfian_generator_t(size_t min, size_t max, float zipfian_const, float zeta_n);
+    zipfian_generator_t(size_t items_count, xoshiro256ss_t rng, double theta = zipfian_const_k)
+        : zipfian_generator_t(0, items_count - 1, rng, theta) {}
+    zipfian_generator_t(size_t min, size_t max, xoshiro256ss_t rng, double theta = zipfian_const_k);
 
-    inline size_t generate() override { return generate(items_count_); }
+    inline size_t generate() override { return last_ = base_ + draw() - 1; }
     inline size_t last() override { return last_; }
+    inline void fill(std::span<size_t> values) override {
+        for (auto& value : values)
+            value = base_ + draw() - 1;
+        if (!values.empty())
+            last_ = values.back();
+    }
+
+    /**
+     * @brief Draws from the first `items_count` items, which may change between calls.
+     */
+    inline size_t generate(size_t items_count) {
+        if (items_count != items_count_)
+            resize(items_count);
+        return generate();
+    }
 
-    size_t generate(size_t items_count);
+    /**
+     * @brief The generalized harmonic number `H(n, theta)`, the sum of `1 / i^theta` for `i` in [1, n].
+     * Sums the first terms and approximates the rest with the Euler–Maclaurin formula,
+     * so it's O(1) and precise to about 1e-7 for any `n`.
+     */
+    static inline double zeta(size_t n, double theta);
 
   private:
-    inline float eta() { return (1 - std::pow(2.f / items_count_, 1 - theta_)) / (1 - zeta_2_ / zeta_n_); }
-    inline float zeta(size_t num, float theta) { return zeta(0, num, theta, 0.f); }
-    inline float zeta(size_t last_num, size_t cur_num, float theta, float last_zeta);
+    inline void resize(size_t items_count);
+    inline size_t draw() noexcept;
 
-    random_double_generator_t generator_;
-    size_t items_count_;
+    inline double h(double x) const noexcept { return std::exp(-theta_ * std::log(x)); }
+    inline double h_integral(double x) const noexcept {
+        double log_x = std::log(x);
+        return helper2((1 - theta_) * log_x) * log_x;
+    }
+    inline double h_integral_inverse(double x) const noexcept {
+        double t = std::max(x * (1 - theta_), -1.0);
+        return std::exp(helper1(t) * x);
+    }
+    // Note: `log1p(x) / x` and `expm1(x) / x`, precise near zero
+    static inline double helper1(double x) noexcept {
+        return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+    }
+    static inline double helper2(double x) noexcept {
+        return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+    }
+
+    xoshiro256ss_t rand_;
     size_t base_;
-    size_t count_for_zeta_;
-    size_t last_;
-    float theta_;
-    float zeta_n_;
-    float eta_;
-    float alpha_;
-    float zeta_2_;
-    bool allow_count_decrease_;
+    size_t items_count_ = 0;
+    size_t last_ = 0;
+    double theta_;
+    double h_integral_x1_;
+    double h_integral_n_;
+    double s_;
 };
 
-zipfian_generator_t::zipfian_generator_t(size_t min, size_t max, float zipfian_const, float zeta_n)
-    : generator_(0.0, 1.0), items_count_(max - min + 1), base_(min), theta_(zipfian_const),
-      allow_count_decrease_(false) {
-    assert(items_count_ >= 2 && items_count_ < items_max_count);
-
-    zeta_2_ = zeta(2, theta_);
-    alpha_ = 1.0 / (1.0 - theta_);
-    zeta_n_ = zeta_n;
-    count_for_zeta_ = items_count_;
-    eta_ = eta();
+zipfian_generator_t::zipfian_generator_t(size_t min, size_t max, xoshiro256ss_t rng, double theta)
+    : rand_(rng), base_(min), theta_(theta) {
+    assert(max >= min && theta > 0);
 
+    h_integral_x1_ = h_integral(1.5) - 1;
+    s_ = 2 - h_integral_inverse(h_integral(2.5) - h(2));
+    resize(max - min + 1);
     generate();
 }
 
-size_t zipfian_generator_t::generate(size_t num) {
-    assert(num >= 2 && num < items_max_count);
-    if (num != count_for_zeta_) {
-        if (num > count_for_zeta_) {
-            zeta_n_ = zeta(count_for_zeta_, num, theta_, zeta_n_);
-            count_for_zeta_ = num;
-            eta_ = eta();
-        }
-        else if (num < count_for_zeta_ && allow_count_decrease_) {
-            // TODO
-        }
-    }
-
-    float u = generator_.generate();
-    float uz = u * zeta_n_;
+inline void zipfian_generator_t::resize(size_t items_count) {
+    assert(items_count >= 1);
+    items_count_ = items_count;
+    h_integral_n_ = h_integral(items_count + 0.5);
+}
 
-    if (uz < 1.0)
-        return last_ = base_;
-    if (uz < 1.0 + std::pow(0.5, theta_))
-        return last_ = base_ + 1;
-    return last_ = base_ + num * std::pow(eta_ * u - eta_ + 1, alpha_);
+inline size_t zipfian_generator_t::draw() noexcept {
+    while (true) {
+        double u = h_integral_n_ + rand_.next_double() * (h_integral_x1_ - h_integral_n_);
+        double x = h_integral_inverse(u);
+        double k = std::clamp(std::floor(x + 0.5), 1.0, double(items_count_));
+        if (k - x <= s_ || u >= h_integral(k + 0.5) - h(k))
+            return size_t(k);
+    }
 }
 
-inline float zipfian_generator_t::zeta(size_t last_num, size_t cur_num, float theta, float last_zeta) {
-    float zeta = last_zeta;
-    for (size_t i = last_num + 1; i <= cur_num; ++i)
-        zeta += 1 / std::pow(i, theta);
-    return zeta;
+inline double zipfian_generator_t::zeta(size_t n, double theta) {
+    constexpr size_t exact_terms_k = 16;
+    double sum = 0;
+    for (size_t i = 1; i <= std::min(n, exact_terms_k); ++i)
+        sum += std::pow(double(i), -theta);
+    if (n <= exact_terms_k)
+        return sum;
+
+    // Note: The tail from `m + 1` to `n`, as the integral with the trapezoid and the first Bernoulli corrections
+    double m = exact_terms_k;
+    double last = double(n);
+    double integral = theta == 1 ? std::log(last / m)
+                                 : (std::pow(last, 1 - theta) - std::pow(m, 1 - theta)) / (1 - theta);
+    double trapezoid = (std::pow(last, -theta) - std::pow(m, -theta)) / 2;
+    double bernoulli = theta * (std::pow(m, -theta - 1) - std::pow(last, -theta - 1)) / 12;
+    return sum + integral + trapezoid + bernoulli;
 }
 
-} // namespace ucsb::core
\ No newline at end of file
+} // namespace ucsb::core
@@ -7,6 +7,9 @@
 
 namespace ucsb {
 
+// Note: `std::hardware_destructive_interference_size` isn't ABI-stable across compiler flags
+constexpr size_t cache_line_size_k = 64;
+
 template <typename at>
 inline at atomic_add_fetch(at& value, at delta) noexcept {
     return __atomic_add_fetch(&value, delta, __ATOMIC_RELAXED);
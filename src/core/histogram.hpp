@@ -0,0 +1,280 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "src/core/operation.hpp"
+#include "src/core/helper.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief HDR-style log-linear histogram of latencies in nanoseconds.
+ * Every power of two is split into `sub_buckets_k` linear sub-buckets,
+ * so the relative error of any reported percentile is below 1/2^sub_bucket_bits.
+ * It's owned and filled by a single thread without any synchronization.
+ * Fields are updated with relaxed stores, so other threads can merge a
+ * consistent enough snapshot of it while it's being filled.
+ */
+template <size_t sub_bucket_bits_ak>
+class basic_latency_histogram_gt {
+  public:
+    static constexpr size_t sub_bucket_bits_k = sub_bucket_bits_ak;
+    static constexpr size_t sub_buckets_k = size_t(1) << sub_bucket_bits_k;
+    // Note: ~18 minutes, longer latencies are clamped
+    static constexpr size_t max_value_bits_k = 40;
+    static constexpr size_t max_value_k = (size_t(1) << max_value_bits_k) - 1;
+    static constexpr size_t buckets_count_k = (max_value_bits_k - sub_bucket_bits_k + 1) * sub_buckets_k;
+
+    inline basic_latency_histogram_gt() noexcept { clear(); }
+
+    // Note: Only the owning thread may call it
+    inline void record(size_t value) noexcept {
+        value = std::min(value, max_value_k);
+        size_t idx = bucket_index(value);
+        atomic_store(counts_[idx], counts_[idx] + 1);
+        atomic_store(count_, count_ + 1);
+        atomic_store(sum_, sum_ + value);
+        if (value < min_)
+            atomic_store(min_, value);
+        if (value > max_)
+            atomic_store(max_, value);
+    }
+
+    inline void merge(basic_latency_histogram_gt const& other) noexcept {
+        for (size_t idx = 0; idx != buckets_count_k; ++idx)
+            counts_[idx] += atomic_load(other.counts_[idx]);
+        count_ += atomic_load(other.count_);
+        sum_ += atomic_load(other.sum_);
+        min_ = std::min(min_, atomic_load(other.min_));
+        max_ = std::max(max_, atomic_load(other.max_));
+    }
+
+    /**
+     * @brief Removes an older snapshot of the same histogram,
+     * leaving only values recorded since then.
+     * The minimum and maximum are approximated by bucket bounds.
+     */
+    inline void subtract(basic_latency_histogram_gt const& older) noexcept {
+        min_ = std::numeric_limits<size_t>::max();
+        max_ = 0;
+        for (size_t idx = 0; idx != buckets_count_k; ++idx) {
+            counts_[idx] -= older.counts_[idx];
+            if (!counts_[idx])
+                continue;
+            min_ = std::min(min_, bucket_lower_bound(idx));
+            max_ = bucket_upper_bound(idx);
+        }
+        count_ -= older.count_;
+        sum_ -= older.sum_;
+    }
+
+    inline void clear() noexcept {
+        counts_.fill(0);
+        count_ = 0;
+        sum_ = 0;
+        min_ = std::numeric_limits<size_t>::max();
+        max_ = 0;
+    }
+
+    /**
+     * @brief Returns the highest value equivalent to the bucket
+     * the requested percentile falls into, clamped by the recorded maximum.
+     *
+     * @param percentile In the [0, 100] range.
+     */
+    inline size_t percentile(double percentile) const noexcept {
+        if (!count_)
+            return 0;
+
+        size_t rank = std::max(size_t(1), size_t(percentile / 100.0 * count_ + 0.5));
+        rank = std::min(rank, count_);
+        size_t seen = 0;
+        for (size_t idx = 0; idx != buckets_count_k; ++idx) {
+            seen += counts_[idx];
+            if (seen >= rank)
+                return std::clamp(bucket_upper_bound(idx), min_, max_);
+        }
+        return max_;
+    }
+
+    inline size_t count() const noexcept { return count_; }
+    inline size_t min() const noexcept { return count_ ? min_ : 0; }
+    inline size_t max() const noexcept { return max_; }
+    inline double mean() const noexcept { return count_ ? double(sum_) / count_ : 0.0; }
+
+  private:
+    static inline size_t bucket_index(size_t value) noexcept {
+        if (value < sub_buckets_k)
+            return value;
+        size_t shift = std::bit_width(value) - 1 - sub_bucket_bits_k;
+        return shift * sub_buckets_k + (value >> shift);
+    }
+
+    static inline size_t bucket_lower_bound(size_t idx) noexcept {
+        if (idx < 2 * sub_buckets_k)
+            return idx;
+        size_t shift = idx / sub_buckets_k - 1;
+        size_t mantissa = idx % sub_buckets_k + sub_buckets_k;
+        return mantissa << shift;
+    }
+
+    static inline size_t bucket_upper_bound(size_t idx) noexcept {
+        if (idx < 2 * sub_buckets_k)
+            return idx;
+        size_t shift = idx / sub_buckets_k - 1;
+        size_t mantissa = idx % sub_buckets_k + sub_buckets_k;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::array<size_t, buckets_count_k> counts_;
+    size_t count_;
+    size_t sum_;
+    size_t min_;
+    size_t max_;
+};
+
+// Note: Below 1/64 relative error
+using latency_histogram_t = basic_latency_histogram_gt<6>;
+
+/**
+ * @brief A set of latency histograms, one per operation kind,
+ * filled by a single worker thread.
+ */
+class operations_histogram_t {
+  public:
+    static constexpr size_t operations_count_k = size_t(operation_kind_t::scan_k) + 1;
+
+    inline void record(operation_kind_t operation, size_t latency) noexcept {
+        histograms_[size_t(operation)].record(latency);
+    }
+
+    inline void merge(operations_histogram_t const& other) noexcept {
+        for (size_t idx = 0; idx != operations_count_k; ++idx)
+            histograms_[idx].merge(other.histograms_[idx]);
+    }
+
+    inline void subtract(operations_histogram_t const& older) noexcept {
+        for (size_t idx = 0; idx != operations_count_k; ++idx)
+            histograms_[idx].subtract(older.histograms_[idx]);
+    }
+
+    inline void clear() noexcept {
+        for (auto& histogram : histograms_)
+            histogram.clear();
+    }
+
+    inline latency_histogram_t const& operator[](operation_kind_t operation) const noexcept {
+        return histograms_[size_t(operation)];
+    }
+
+    /**
+     * @brief Merges histograms of all operation kinds into one.
+     */
+    inline latency_histogram_t total() const noexcept {
+        latency_histogram_t total;
+        for (auto const& histogram : histograms_)
+            total.merge(histogram);
+        return total;
+    }
+
+  private:
+    std::array<latency_histogram_t, operations_count_k> histograms_;
+};
+
+/**
+ * @brief A 2D histogram of batch lengths and latencies of batch operations,
+ * filled by a single worker thread. Batch lengths are grouped by powers of two
+ * and every group keeps its own coarser latency histogram, along with the number
+ * of entries, to derive the amortized latency per entry.
+ */
+class batches_histogram_t {
+  public:
+    // Note: Below 1/8 relative error, to keep it small enough for every thread
+    using histogram_t = basic_latency_histogram_gt<3>;
+    // Note: Longer batches fall into the last group
+    static constexpr size_t length_groups_k = 21;
+    static constexpr size_t operations_count_k = 4;
+
+    /**
+     * @brief Whether the operation passes a batch of entries, whose length is drawn from a distribution.
+     */
+    static inline bool tracks(operation_kind_t operation) noexcept { return operation_index(operation) != npos_k; }
+
+    // Note: Only the owning thread may call it
+    inline void record(operation_kind_t operation, size_t length, size_t latency) noexcept {
+        size_t group = length_group(length);
+        auto& operation_groups = groups_[operation_index(operation)];
+        operation_groups.histograms[group].record(latency);
+        atomic_store(operation_groups.entries[group], operation_groups.entries[group] + length);
+    }
+
+    inline void merge(batches_histogram_t const& other) noexcept {
+        for (size_t op_idx = 0; op_idx != operations_count_k; ++op_idx) {
+            for (size_t group = 0; group != length_groups_k; ++group) {
+                groups_[op_idx].histograms[group].merge(other.groups_[op_idx].histograms[group]);
+                groups_[op_idx].entries[group] += atomic_load(other.groups_[op_idx].entries[group]);
+            }
+        }
+    }
+
+    inline void subtract(batches_histogram_t const& older) noexcept {
+        for (size_t op_idx = 0; op_idx != operations_count_k; ++op_idx) {
+            for (size_t group = 0; group != length_groups_k; ++group) {
+                groups_[op_idx].histograms[group].subtract(older.groups_[op_idx].histograms[group]);
+                groups_[op_idx].entries[group] -= older.groups_[op_idx].entries[group];
+            }
+        }
+    }
+
+    inline void clear() noexcept {
+        for (auto& operation_groups : groups_) {
+            for (auto& histogram : operation_groups.histograms)
+                histogram.clear();
+            operation_groups.entries.fill(0);
+        }
+    }
+
+    inline histogram_t const& latencies(operation_kind_t operation, size_t group) const noexcept {
+        return groups_[operation_index(operation)].histograms[group];
+    }
+    inline size_t entries(operation_kind_t operation, size_t group) const noexcept {
+        return groups_[operation_index(operation)].entries[group];
+    }
+
+    // Note: Bounds are inclusive
+    static inline size_t group_min_length(size_t group) noexcept { return size_t(1) << group; }
+    static inline size_t group_max_length(size_t group) noexcept {
+        return group + 1 == length_groups_k ? std::numeric_limits<size_t>::max() : (size_t(2) << group) - 1;
+    }
+
+  private:
+    static constexpr size_t npos_k = std::numeric_limits<size_t>::max();
+
+    struct operation_groups_t {
+        std::array<histogram_t, length_groups_k> histograms;
+        std::array<size_t, length_groups_k> entries {};
+    };
+
+    static inline size_t operation_index(operation_kind_t operation) noexcept {
+        switch (operation) {
+        case operation_kind_t::batch_upsert_k: return 0;
+        case operation_kind_t::batch_read_k: return 1;
+        case operation_kind_t::bulk_load_k: return 2;
+        case operation_kind_t::range_select_k: return 3;
+        default: return npos_k;
+        }
+    }
+
+    static inline size_t length_group(size_t length) noexcept {
+        return std::min(size_t(std::bit_width(std::max(length, size_t(1)))) - 1, length_groups_k - 1);
+    }
+
+    std::array<operation_groups_t, operations_count_k> groups_;
+};
+
+} // namespace ucsb
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include "src/core/types.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Bytes and requests that reached the storage, either on behalf of this
+ * process, or on the block devices backing the DB directories.
+ */
+struct io_counters_t {
+    // From "/proc/self/io", attributed to this process only
+    size_t process_read_bytes = 0;
+    size_t process_written_bytes = 0;
+    // From "/sys/dev/block/*/stat", including other processes using the same devices
+    size_t device_read_bytes = 0;
+    size_t device_written_bytes = 0;
+    size_t device_read_requests = 0;
+    size_t device_write_requests = 0;
+
+    inline void subtract(io_counters_t const& older) noexcept {
+        process_read_bytes -= older.process_read_bytes;
+        process_written_bytes -= older.process_written_bytes;
+        device_read_bytes -= older.device_read_bytes;
+        device_written_bytes -= older.device_written_bytes;
+        device_read_requests -= older.device_read_requests;
+        device_write_requests -= older.device_write_requests;
+    }
+};
+
+/**
+ * @brief Snapshots disk I/O statistics from OS before and after a workload.
+ * Devices are resolved from the given directories, so partitions, RAID and
+ * device-mapper volumes are accounted as the kernel sees them. Directories
+ * on virtual file systems (tmpfs, overlayfs, etc.) have no block device and
+ * contribute only to the process counters.
+ * Note: Writeback is asynchronous, so bytes written by the kernel after
+ * the workload is over aren't accounted, unless the DB flushes them.
+ */
+class io_profiler_t {
+  public:
+    inline io_profiler_t(std::vector<fs::path> const& dir_paths);
+
+    inline void start() { start_ = snapshot(); }
+    inline void stop() { stop_ = snapshot(); }
+
+    inline bool has_devices() const noexcept { return !device_stat_paths_.empty(); }
+    inline io_counters_t counters() const noexcept {
+        io_counters_t counters = stop_;
+        counters.subtract(start_);
+        return counters;
+    }
+
+  private:
+    // Note: Regardless of the actual sector size of the device
+    static constexpr size_t sector_size_k = 512;
+
+    inline io_counters_t snapshot() const;
+    static inline void read_process_io(io_counters_t& counters);
+    static inline void read_device_io(fs::path const& stat_path, io_counters_t& counters);
+
+    std::vector<fs::path> device_stat_paths_;
+    io_counters_t start_;
+    io_counters_t stop_;
+};
+
+inline io_profiler_t::io_profiler_t(std::vector<fs::path> const& dir_paths) {
+    for (auto const& dir_path : dir_paths) {
+        struct stat dir_stat;
+        if (dir_path.empty() || ::stat(dir_path.c_str(), &dir_stat) != 0)
+            continue;
+
+        // Note: Anonymous devices have no block statistics
+        auto major_id = major(dir_stat.st_dev);
+        auto minor_id = minor(dir_stat.st_dev);
+        if (major_id == 0)
+            continue;
+
+        fs::path stat_path = fmt::format("/sys/dev/block/{}:{}/stat", major_id, minor_id);
+        if (!fs::exists(stat_path))
+            continue;
+        if (std::find(device_stat_paths_.begin(), device_stat_paths_.end(), stat_path) == device_stat_paths_.end())
+            device_stat_paths_.push_back(stat_path);
+    }
+}
+
+inline io_counters_t io_profiler_t::snapshot() const {
+    io_counters_t counters;
+    read_process_io(counters);
+    for (auto const& stat_path : device_stat_paths_)
+        read_device_io(stat_path, counters);
+    return counters;
+}
+
+inline void io_profiler_t::read_process_io(io_counters_t& counters) {
+    std::ifstream stream("/proc/self/io", std::ios_base::in);
+    std::string key;
+    size_t value = 0;
+    while (stream >> key >> value) {
+        if (key == "read_bytes:")
+            counters.process_read_bytes = value;
+        else if (key == "write_bytes:")
+            counters.process_written_bytes = value;
+    }
+}
+
+inline void io_profiler_t::read_device_io(fs::path const& stat_path, io_counters_t& counters) {
+    // Reads: requests, merged, sectors, ticks, Writes: requests, merged, sectors, ticks, ...
+    std::ifstream stream(stat_path, std::ios_base::in);
+    size_t read_requests = 0, read_merges = 0, read_sectors = 0, read_ticks = 0;
+    size_t write_requests = 0, write_merges = 0, write_sectors = 0;
+    if (!(stream >> read_requests >> read_merges >> read_sectors >> read_ticks >> write_requests >> write_merges >>
+          write_sectors))
+        return;
+
+    counters.device_read_requests += read_requests;
+    counters.device_write_requests += write_requests;
+    counters.device_read_bytes += read_sectors * sector_size_k;
+    counters.device_written_bytes += write_sectors * sector_size_k;
+}
+
+} // namespace ucsb
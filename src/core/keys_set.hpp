@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+
+#include "src/core/types.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Open-addressing set of keys with linear probing, used to deduplicate batches.
+ * The capacity is fixed at construction, and clearing is O(1): instead of wiping
+ * the slots, it bumps the epoch, that marks the slots occupied in the current batch.
+ * So unlike `std::set`, it doesn't allocate after construction.
+ */
+class keys_set_t {
+  public:
+    inline keys_set_t() = default;
+    inline keys_set_t(size_t max_count)
+        : mask_(std::bit_ceil(std::max<size_t>(max_count * 2, 2)) - 1), keys_(mask_ + 1), epochs_(mask_ + 1, 0),
+          epoch_(1) {}
+
+    inline void clear() noexcept {
+        ++epoch_;
+        // Note: On wrap-around old epochs can't be told apart, so wipe them
+        if (epoch_ == 0) {
+            std::fill(epochs_.begin(), epochs_.end(), 0);
+            epoch_ = 1;
+        }
+    }
+
+    /**
+     * @brief Inserts the key, unless it's already present.
+     * ! Inserting more keys than the capacity, given at construction, is undefined.
+     * @return True, if the key was inserted.
+     */
+    inline bool insert(key_t key) noexcept {
+        // Note: Fibonacci hashing spreads sequential keys
+        size_t idx = (key * 0x9E3779B97F4A7C15ull) >> 32 & mask_;
+        while (epochs_[idx] == epoch_) {
+            if (keys_[idx] == key)
+                return false;
+            idx = (idx + 1) & mask_;
+        }
+        keys_[idx] = key;
+        epochs_[idx] = epoch_;
+        return true;
+    }
+
+  private:
+    size_t mask_ = 0;
+    std::vector<key_t> keys_;
+    std::vector<uint32_t> epochs_;
+    uint32_t epoch_ = 1;
+};
+
+} // namespace ucsb
@@ -22,6 +22,62 @@ enum class operation_kind_t {
     scan_k,
 };
 
+inline char const* operation_name(operation_kind_t operation) noexcept {
+    switch (operation) {
+    case operation_kind_t::upsert_k: return "upsert";
+    case operation_kind_t::update_k: return "update";
+    case operation_kind_t::remove_k: return "remove";
+    case operation_kind_t::read_k: return "read";
+    case operation_kind_t::read_modify_write_k: return "read_modify_write";
+    case operation_kind_t::batch_upsert_k: return "batch_upsert";
+    case operation_kind_t::batch_read_k: return "batch_read";
+    case operation_kind_t::bulk_load_k: return "bulk_load";
+    case operation_kind_t::range_select_k: return "range_select";
+    case operation_kind_t::scan_k: return "scan";
+    default: return "unknown";
+    }
+}
+
+/**
+ * @brief Whether the operation passes values to the DB to be stored.
+ */
+inline bool is_write(operation_kind_t operation) noexcept {
+    switch (operation) {
+    case operation_kind_t::upsert_k:
+    case operation_kind_t::update_k:
+    case operation_kind_t::read_modify_write_k:
+    case operation_kind_t::batch_upsert_k:
+    case operation_kind_t::bulk_load_k: return true;
+    default: return false;
+    }
+}
+
+/**
+ * @brief Whether the operation fetches values from the DB.
+ */
+inline bool is_read(operation_kind_t operation) noexcept {
+    switch (operation) {
+    case operation_kind_t::read_k:
+    case operation_kind_t::read_modify_write_k:
+    case operation_kind_t::batch_read_k:
+    case operation_kind_t::range_select_k:
+    case operation_kind_t::scan_k: return true;
+    default: return false;
+    }
+}
+
+/**
+ * @brief Whether the operation passes many keys at once.
+ */
+inline bool is_batch(operation_kind_t operation) noexcept {
+    switch (operation) {
+    case operation_kind_t::batch_upsert_k:
+    case operation_kind_t::batch_read_k:
+    case operation_kind_t::bulk_load_k: return true;
+    default: return false;
+    }
+}
+
 enum class operation_status_t : int {
     ok_k = 1,
     error_k = -1,
@@ -44,7 +100,7 @@ struct operation_result_t {
 
 class operation_chooser_t {
   public:
-    inline operation_chooser_t() : generator_(0.0, 1.0), sum_(0) {}
+    inline operation_chooser_t(core::xoshiro256ss_t rng) : generator_(0.0, 1.0, rng), sum_(0) {}
 
     inline void add(operation_kind_t op, float weight);
     inline operation_kind_t choose();
@@ -56,6 +112,9 @@ class operation_chooser_t {
 };
 
 inline void operation_chooser_t::add(operation_kind_t op, float weight) {
+    // Note: Operations, that never happen, must not be picked by rounding either
+    if (weight <= 0)
+        return;
     ops_.push_back(std::make_pair(op, weight));
     sum_ += weight;
 }
@@ -69,8 +128,9 @@ inline operation_kind_t operation_chooser_t::choose() {
         chooser -= part;
     }
 
-    assert(false);
-    return operation_kind_t::read_k;
+    // Note: Rounding of the parts may leave the chooser just above the last one
+    assert(!ops_.empty());
+    return ops_.back().first;
 }
 
 } // namespace ucsb
\ No newline at end of file
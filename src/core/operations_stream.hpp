@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "src/core/types.hpp"
+#include "src/core/timer.hpp"
+#include "src/core/operation.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief A chunk of pre-generated operations of a single thread, stored as a structure of arrays.
+ * Every operation consumes its arguments from the arrays in the same order they were pushed in,
+ * so each array needs just a single read cursor, and replaying is a sequential scan.
+ * Clearing keeps the capacity, so regenerating chunks of the same size doesn't allocate.
+ */
+class operations_stream_t {
+  public:
+    inline void reserve(size_t operations_count) {
+        operations_.reserve(operations_count);
+        keys_.reserve(operations_count);
+        value_lengths_.reserve(operations_count);
+    }
+
+    inline void clear() noexcept {
+        operations_.clear();
+        keys_.clear();
+        lengths_.clear();
+        value_lengths_.clear();
+        times_.clear();
+        operation_idx_ = 0;
+        key_idx_ = 0;
+        length_idx_ = 0;
+        value_length_idx_ = 0;
+    }
+
+    inline size_t size() const noexcept { return operations_.size(); }
+    inline size_t left() const noexcept { return operations_.size() - operation_idx_; }
+
+    inline void push_operation(operation_kind_t operation) { operations_.push_back(uint8_t(operation)); }
+    inline void push_key(key_t key) { keys_.push_back(key); }
+    inline void push_length(size_t length) { lengths_.push_back(length); }
+    inline void push_value_length(value_length_t length) { value_lengths_.push_back(length); }
+    // Note: Only replayed traces have arrival times, one per operation
+    inline void push_time(elapsed_time_t time) { times_.push_back(time); }
+
+    inline operation_kind_t pop_operation() noexcept { return operation_kind_t(operations_[operation_idx_++]); }
+    inline key_t pop_key() noexcept { return keys_[key_idx_++]; }
+    inline keys_spanc_t pop_keys(size_t count) noexcept {
+        keys_spanc_t keys(keys_.data() + key_idx_, count);
+        key_idx_ += count;
+        return keys;
+    }
+    inline size_t pop_length() noexcept { return lengths_[length_idx_++]; }
+    inline value_length_t pop_value_length() noexcept { return value_lengths_[value_length_idx_++]; }
+    // Note: Doesn't advance, the time belongs to the operation popped next
+    inline elapsed_time_t peek_time() const noexcept { return times_[operation_idx_]; }
+
+  private:
+    std::vector<uint8_t> operations_;
+    keys_t keys_;
+    std::vector<size_t> lengths_;
+    value_lengths_t value_lengths_;
+    std::vector<elapsed_time_t> times_;
+
+    size_t operation_idx_ = 0;
+    size_t key_idx_ = 0;
+    size_t length_idx_ = 0;
+    size_t value_length_idx_ = 0;
+};
+
+} // namespace ucsb
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#include "src/core/timer.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Schedules operations of a single thread at a fixed rate, for open-loop benchmarks.
+ * Every operation gets an intended start time, that doesn't depend on how long the
+ * previous ones took. Measuring latencies from it, instead of the actual start time,
+ * accounts for the queueing delay a real client would observe, avoiding the so called
+ * "Coordinated Omission" problem.
+ *
+ * @see "How NOT to Measure Latency" by Gil Tene.
+ */
+class pacer_t {
+  public:
+    // Note: Below this threshold we spin instead of sleeping, as OS timers aren't precise enough
+    static constexpr elapsed_time_t spin_threshold_k = std::chrono::microseconds(100);
+
+    inline pacer_t(double ops_per_second)
+        : interval_(ops_per_second > 0 ? elapsed_time_t(size_t(1'000'000'000.0 / ops_per_second))
+                                       : elapsed_time_t(0)) {}
+
+    inline bool enabled() const noexcept { return interval_.count() != 0; }
+
+    inline void start() { start_time_ = next_time_ = high_resolution_clock_t::now(); }
+
+    /**
+     * @brief Changes the rate of the following operations. Call `start()` afterwards to drop the backlog.
+     */
+    inline void set_rate(double ops_per_second) noexcept {
+        interval_ = ops_per_second > 0 ? elapsed_time_t(size_t(1'000'000'000.0 / ops_per_second)) : elapsed_time_t(0);
+    }
+
+    /**
+     * @brief Waits for the intended start time of the next operation.
+     * @return How far behind the schedule the operation is actually started.
+     */
+    inline elapsed_time_t wait() {
+        time_point_t intended_time = next_time_;
+        next_time_ += interval_;
+        return wait_until(intended_time);
+    }
+
+    /**
+     * @brief Waits for an arbitrary schedule, like the one of a replayed trace, instead of the fixed rate.
+     * @return How far behind the schedule the operation is actually started.
+     */
+    inline elapsed_time_t wait_since_start(elapsed_time_t offset) { return wait_until(start_time_ + offset); }
+
+  private:
+    inline elapsed_time_t wait_until(time_point_t intended_time) {
+        auto now = high_resolution_clock_t::now();
+        if (now >= intended_time)
+            return std::chrono::duration_cast<elapsed_time_t>(now - intended_time);
+
+        if (intended_time - now > spin_threshold_k)
+            std::this_thread::sleep_until(intended_time - spin_threshold_k);
+        while (high_resolution_clock_t::now() < intended_time)
+            ;
+        return elapsed_time_t(0);
+    }
+
+    elapsed_time_t interval_;
+    time_point_t start_time_;
+    time_point_t next_time_;
+};
+
+} // namespace ucsb
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include "src/core/helper.hpp"
+
+namespace ucsb {
+
+enum class hw_event_t {
+    cycles_k = 0,
+    instructions_k,
+    llc_misses_k,
+    branch_misses_k,
+    dtlb_misses_k,
+};
+
+inline char const* hw_event_name(hw_event_t event) {
+    switch (event) {
+    case hw_event_t::cycles_k: return "cycles";
+    case hw_event_t::instructions_k: return "instructions";
+    case hw_event_t::llc_misses_k: return "llc_misses";
+    case hw_event_t::branch_misses_k: return "branch_misses";
+    case hw_event_t::dtlb_misses_k: return "dtlb_misses";
+    default: return "unknown";
+    }
+}
+
+/**
+ * @brief Hardware events counted over some period of time.
+ * `targets` is the number of threads or thread trees, that contributed to it,
+ * so that incomplete sums can be told apart after merging.
+ */
+struct hw_counters_t {
+    static constexpr size_t events_count_k = size_t(hw_event_t::dtlb_misses_k) + 1;
+
+    std::array<size_t, events_count_k> values {};
+    size_t targets = 0;
+
+    inline size_t operator[](hw_event_t event) const noexcept { return values[size_t(event)]; }
+
+    // Note: Only the owning thread may call it
+    inline void store(hw_counters_t const& other) noexcept {
+        for (size_t idx = 0; idx != events_count_k; ++idx)
+            atomic_store(values[idx], other.values[idx]);
+        atomic_store(targets, other.targets);
+    }
+
+    inline void merge(hw_counters_t const& other) noexcept {
+        for (size_t idx = 0; idx != events_count_k; ++idx)
+            values[idx] += atomic_load(other.values[idx]);
+        targets += atomic_load(other.targets);
+    }
+
+    inline void subtract(hw_counters_t const& older) noexcept {
+        for (size_t idx = 0; idx != events_count_k; ++idx)
+            values[idx] -= older.values[idx];
+        targets -= older.targets;
+    }
+
+    inline double ipc() const noexcept {
+        auto cycles = (*this)[hw_event_t::cycles_k];
+        return cycles ? double((*this)[hw_event_t::instructions_k]) / cycles : 0.0;
+    }
+};
+
+/**
+ * @brief Counts hardware events with Linux `perf_event_open`, either for the calling
+ * thread only, or for the whole process including DB background threads.
+ * Every event is opened separately, so the kernel may multiplex them, in which
+ * case the values are scaled by the time each of them was actually counting.
+ * When `perf_event_paranoid` forbids counting kernel code only the user space is counted,
+ * and when it forbids everything or the PMU isn't virtualized, counters are just unavailable.
+ *
+ * @see perf_event_open(2): https://man7.org/linux/man-pages/man2/perf_event_open.2.html
+ */
+class perf_counters_t {
+  public:
+    enum class scope_t {
+        thread_k,
+        process_k,
+    };
+
+    inline perf_counters_t() = default;
+    perf_counters_t(perf_counters_t const&) = delete;
+    perf_counters_t& operator=(perf_counters_t const&) = delete;
+    ~perf_counters_t() { close(); }
+
+    /**
+     * @brief Opens counters for the calling thread, or for all threads of the process,
+     * existing at the moment, and threads they spawn later.
+     * @return False, if counting isn't permitted or supported.
+     */
+    inline bool open(scope_t scope);
+    inline void close();
+
+    inline bool opened() const noexcept { return !targets_.empty(); }
+
+    inline void start();
+    inline void stop();
+    inline hw_counters_t read() const;
+
+    /**
+     * @brief Checks once per process, which events can be counted.
+     */
+    static inline bool supported(hw_event_t event);
+    static inline bool available();
+    static inline int paranoid_level();
+
+  private:
+    using target_fds_t = std::array<int, hw_counters_t::events_count_k>;
+
+    struct probe_t {
+        std::array<bool, hw_counters_t::events_count_k> supported {};
+        bool exclude_kernel = false;
+        bool any = false;
+    };
+
+    static inline probe_t const& probe();
+    static inline int open_event(hw_event_t event, pid_t tid, bool inherit, bool exclude_kernel);
+    static inline void close_fds(target_fds_t& fds);
+    inline bool open_target(pid_t tid, bool inherit);
+
+    std::vector<target_fds_t> targets_;
+};
+
+inline int perf_counters_t::open_event(hw_event_t event, pid_t tid, bool inherit, bool exclude_kernel) {
+
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.inherit = inherit;
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event) {
+    case hw_event_t::cycles_k:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case hw_event_t::instructions_k:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case hw_event_t::llc_misses_k:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case hw_event_t::branch_misses_k:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case hw_event_t::dtlb_misses_k:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    default: return -1;
+    }
+
+    return syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0);
+}
+
+inline void perf_counters_t::close_fds(target_fds_t& fds) {
+    for (auto& fd : fds) {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+inline perf_counters_t::probe_t const& perf_counters_t::probe() {
+    // Note: Initialized once in a thread-safe manner
+    static probe_t const probe = []() {
+        probe_t probe;
+        for (bool exclude_kernel : {false, true}) {
+            probe.exclude_kernel = exclude_kernel;
+            for (size_t idx = 0; idx != hw_counters_t::events_count_k; ++idx) {
+                int fd = open_event(hw_event_t(idx), 0, false, exclude_kernel);
+                probe.supported[idx] = fd >= 0;
+                probe.any |= fd >= 0;
+                if (fd >= 0)
+                    ::close(fd);
+            }
+            if (probe.any)
+                break;
+        }
+        return probe;
+    }();
+    return probe;
+}
+
+inline bool perf_counters_t::supported(hw_event_t event) { return probe().supported[size_t(event)]; }
+
+inline bool perf_counters_t::available() { return probe().any; }
+
+inline int perf_counters_t::paranoid_level() {
+    std::ifstream stream("/proc/sys/kernel/perf_event_paranoid");
+    int level = 0;
+    if (!(stream >> level))
+        return -1;
+    return level;
+}
+
+inline bool perf_counters_t::open_target(pid_t tid, bool inherit) {
+    auto const& probe = perf_counters_t::probe();
+    target_fds_t fds;
+    fds.fill(-1);
+    for (size_t idx = 0; idx != hw_counters_t::events_count_k; ++idx) {
+        if (!probe.supported[idx])
+            continue;
+        fds[idx] = open_event(hw_event_t(idx), tid, inherit, probe.exclude_kernel);
+        if (fds[idx] < 0) {
+            close_fds(fds);
+            return false;
+        }
+    }
+    targets_.push_back(fds);
+    return true;
+}
+
+inline bool perf_counters_t::open(scope_t scope) {
+    close();
+    if (!available())
+        return false;
+
+    if (scope == scope_t::thread_k)
+        return open_target(0, false);
+
+    // Note: Threads may exit while we iterate, those are just skipped
+    std::error_code error;
+    for (auto const& entry : std::filesystem::directory_iterator("/proc/self/task", error)) {
+        pid_t tid = std::atoi(entry.path().filename().c_str());
+        if (tid > 0)
+            open_target(tid, true);
+    }
+    return opened();
+}
+
+inline void perf_counters_t::close() {
+    for (auto& fds : targets_)
+        close_fds(fds);
+    targets_.clear();
+}
+
+inline void perf_counters_t::start() {
+    for (auto const& fds : targets_) {
+        for (int fd : fds) {
+            if (fd < 0)
+                continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+inline void perf_counters_t::stop() {
+    for (auto const& fds : targets_)
+        for (int fd : fds)
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+inline hw_counters_t perf_counters_t::read() const {
+    hw_counters_t counters;
+    for (auto const& fds : targets_) {
+        for (size_t idx = 0; idx != hw_counters_t::events_count_k; ++idx) {
+            if (fds[idx] < 0)
+                continue;
+            // Value, time enabled, time running
+            uint64_t data[3] = {0, 0, 0};
+            if (::read(fds[idx], data, sizeof(data)) != sizeof(data) || !data[2])
+                continue;
+            double scale = data[1] > data[2] ? double(data[1]) / data[2] : 1.0;
+            counters.values[idx] += size_t(data[0] * scale);
+        }
+        ++counters.targets;
+    }
+    return counters;
+}
+
+} // namespace ucsb
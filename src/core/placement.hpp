@@ -0,0 +1,303 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <array>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include "src/core/types.hpp"
+#include "src/core/helper.hpp"
+#include "src/core/exception.hpp"
+
+namespace ucsb {
+
+inline char const* huge_pages_name(huge_pages_t huge_pages) {
+    switch (huge_pages) {
+    case huge_pages_t::none_k: return "none";
+    case huge_pages_t::transparent_k: return "thp";
+    case huge_pages_t::hugetlb_k: return "hugetlb";
+    default: return "unknown";
+    }
+}
+
+inline huge_pages_t parse_huge_pages(std::string const& name) {
+    if (name == "none")
+        return huge_pages_t::none_k;
+    if (name == "thp")
+        return huge_pages_t::transparent_k;
+    if (name == "hugetlb")
+        return huge_pages_t::hugetlb_k;
+    throw exception_t(fmt::format("Unknown huge pages kind: {}", name));
+}
+
+/**
+ * @brief Huge pages reserved in the system pool, that `MAP_HUGETLB` allocates from.
+ */
+inline size_t reserved_huge_pages() {
+    std::ifstream stream("/proc/sys/vm/nr_hugepages", std::ios_base::in);
+    size_t count = 0;
+    stream >> count;
+    return count;
+}
+
+/**
+ * @brief Parses CPU lists in the Linux format, like "0-3,8,10-11".
+ */
+inline std::vector<size_t> parse_cpu_list(std::string const& list) {
+    std::vector<size_t> cpus;
+    for (auto const& range : split(list, ',')) {
+        if (range.empty())
+            continue;
+        size_t dash = range.find('-');
+        try {
+            size_t first = std::stoull(range.substr(0, dash));
+            size_t last = dash == std::string::npos ? first : std::stoull(range.substr(dash + 1));
+            for (size_t cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        catch (std::exception const&) {
+            throw exception_t(fmt::format("Invalid CPU list: {}", list));
+        }
+    }
+    return cpus;
+}
+
+struct cpu_info_t {
+    size_t cpu = 0;
+    size_t core = 0;
+    size_t socket = 0;
+    size_t node = 0;
+};
+
+/**
+ * @brief Logical CPUs this process is allowed to run on, with their physical cores,
+ * sockets and NUMA nodes, as reported by "/sys/devices/system".
+ */
+class cpu_topology_t {
+  public:
+    inline cpu_topology_t();
+
+    inline std::vector<cpu_info_t> const& cpus() const noexcept { return cpus_; }
+    inline cpu_info_t const* find(size_t cpu) const noexcept {
+        auto it = std::find_if(cpus_.begin(), cpus_.end(), [=](cpu_info_t const& info) { return info.cpu == cpu; });
+        return it != cpus_.end() ? &*it : nullptr;
+    }
+
+    inline size_t sockets_count() const noexcept { return count_distinct(&cpu_info_t::socket); }
+    inline size_t nodes_count() const noexcept { return count_distinct(&cpu_info_t::node); }
+    inline size_t cores_count() const noexcept { return one_per_core().size(); }
+
+    /**
+     * @brief The first logical CPU of every physical core, ordered by NUMA node,
+     * so that fewer workers than cores stay within as few nodes as possible.
+     */
+    inline std::vector<size_t> one_per_core() const;
+
+  private:
+    static inline size_t read_number(std::string const& path) {
+        std::ifstream stream(path, std::ios_base::in);
+        size_t number = 0;
+        stream >> number;
+        return number;
+    }
+    static inline std::string read_line(std::string const& path) {
+        std::ifstream stream(path, std::ios_base::in);
+        std::string line;
+        std::getline(stream, line);
+        return line;
+    }
+
+    inline size_t count_distinct(size_t cpu_info_t::*field) const {
+        std::vector<size_t> values;
+        for (auto const& info : cpus_)
+            values.push_back(info.*field);
+        std::sort(values.begin(), values.end());
+        return std::unique(values.begin(), values.end()) - values.begin();
+    }
+
+    std::vector<cpu_info_t> cpus_;
+};
+
+inline cpu_topology_t::cpu_topology_t() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    std::string const cpu_dir = "/sys/devices/system/cpu";
+    for (size_t cpu : parse_cpu_list(read_line(fmt::format("{}/online", cpu_dir)))) {
+        if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed))
+            continue;
+        cpu_info_t info;
+        info.cpu = cpu;
+        info.core = read_number(fmt::format("{}/cpu{}/topology/core_id", cpu_dir, cpu));
+        info.socket = read_number(fmt::format("{}/cpu{}/topology/physical_package_id", cpu_dir, cpu));
+        cpus_.push_back(info);
+    }
+
+    // Note: Kernels built without NUMA support have no nodes, so everything stays on node 0
+    std::string const node_dir = "/sys/devices/system/node";
+    for (size_t node : parse_cpu_list(read_line(fmt::format("{}/online", node_dir)))) {
+        for (size_t cpu : parse_cpu_list(read_line(fmt::format("{}/node{}/cpulist", node_dir, node)))) {
+            auto it = std::find_if(cpus_.begin(), cpus_.end(), [=](cpu_info_t const& info) { return info.cpu == cpu; });
+            if (it != cpus_.end())
+                it->node = node;
+        }
+    }
+}
+
+inline std::vector<size_t> cpu_topology_t::one_per_core() const {
+    std::vector<cpu_info_t> cpus = cpus_;
+    std::sort(cpus.begin(), cpus.end(), [](cpu_info_t const& left, cpu_info_t const& right) {
+        return std::tie(left.node, left.socket, left.core, left.cpu) <
+               std::tie(right.node, right.socket, right.core, right.cpu);
+    });
+
+    std::vector<size_t> firsts;
+    for (size_t idx = 0; idx != cpus.size(); ++idx) {
+        bool same_core = idx && cpus[idx].socket == cpus[idx - 1].socket && cpus[idx].core == cpus[idx - 1].core;
+        if (!same_core)
+            firsts.push_back(cpus[idx].cpu);
+    }
+    return firsts;
+}
+
+/**
+ * @brief Decides, where every worker thread runs and allocates memory.
+ * Workers are pinned round-robin to the chosen CPUs. With NUMA binding,
+ * each worker allocates only from the node of its CPU, so the buffers
+ * it touches first, and the DB memory it populates, stay local.
+ */
+class threads_placement_t {
+  public:
+    inline threads_placement_t() = default;
+    /**
+     * @param cpus_list Either empty to let the OS schedule workers,
+     * "cores" for one worker per physical core, or a CPU list, like "0-3,8".
+     */
+    inline threads_placement_t(std::string const& cpus_list, bool numa_bind, size_t threads_count);
+
+    inline bool pinned() const noexcept { return !threads_cpus_.empty(); }
+    inline bool numa_bound() const noexcept { return numa_bind_; }
+    inline cpu_topology_t const& topology() const noexcept { return topology_; }
+
+    inline size_t cpu(size_t thread_idx) const noexcept { return threads_cpus_[thread_idx]; }
+    inline size_t node(size_t thread_idx) const noexcept { return topology_.find(cpu(thread_idx))->node; }
+    inline size_t threads_count() const noexcept { return threads_cpus_.size(); }
+    inline bool oversubscribed() const noexcept { return threads_cpus_.size() > cpus_count_; }
+
+  private:
+    cpu_topology_t topology_;
+    std::vector<size_t> threads_cpus_;
+    size_t cpus_count_ = 0;
+    bool numa_bind_ = false;
+};
+
+inline threads_placement_t::threads_placement_t(std::string const& cpus_list, bool numa_bind, size_t threads_count)
+    : numa_bind_(numa_bind) {
+
+    if (cpus_list.empty()) {
+        if (numa_bind)
+            throw exception_t("NUMA binding requires pinning threads to CPUs");
+        return;
+    }
+
+    std::vector<size_t> cpus = cpus_list == "cores" ? topology_.one_per_core() : parse_cpu_list(cpus_list);
+    if (cpus.empty())
+        throw exception_t(fmt::format("No CPUs to pin threads to: {}", cpus_list));
+    for (size_t cpu : cpus)
+        if (!topology_.find(cpu))
+            throw exception_t(fmt::format("CPU {} is offline or not allowed for this process", cpu));
+
+    for (size_t thread_idx = 0; thread_idx != threads_count; ++thread_idx)
+        threads_cpus_.push_back(cpus[thread_idx % cpus.size()]);
+    cpus_count_ = cpus.size();
+}
+
+/**
+ * @brief Pins the calling worker thread and binds its memory for the lifetime of the scope.
+ * Note: Threads spawned meanwhile inherit both, including the DB background threads,
+ * so spawn those `unpinned()`.
+ */
+class thread_placement_guard_t {
+  public:
+    inline thread_placement_guard_t(threads_placement_t const& placement, size_t thread_idx);
+    inline ~thread_placement_guard_t() { restore(); }
+
+    /**
+     * @brief Calls the function with the original placement, so that threads it spawns aren't pinned.
+     */
+    template <typename func_at>
+    inline void unpinned(func_at&& func) {
+        restore();
+        func();
+        apply();
+    }
+
+  private:
+    // Note: Large enough for any `CONFIG_NODES_SHIFT`
+    static constexpr size_t nodes_mask_bits_k = 1024;
+    using nodes_mask_t = std::array<unsigned long, nodes_mask_bits_k / (8 * sizeof(unsigned long))>;
+
+    inline void apply();
+    inline void restore() noexcept;
+
+    threads_placement_t const* placement_;
+    size_t thread_idx_;
+    cpu_set_t original_cpus_;
+    int original_policy_ = MPOL_DEFAULT;
+    nodes_mask_t original_nodes_ {};
+};
+
+inline thread_placement_guard_t::thread_placement_guard_t(threads_placement_t const& placement, size_t thread_idx)
+    : placement_(&placement), thread_idx_(thread_idx) {
+
+    if (!placement_->pinned())
+        return;
+    CPU_ZERO(&original_cpus_);
+    pthread_getaffinity_np(pthread_self(), sizeof(original_cpus_), &original_cpus_);
+    if (placement_->numa_bound())
+        syscall(SYS_get_mempolicy, &original_policy_, original_nodes_.data(), nodes_mask_bits_k, nullptr, 0);
+    apply();
+}
+
+inline void thread_placement_guard_t::apply() {
+    if (!placement_->pinned())
+        return;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(placement_->cpu(thread_idx_), &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+        throw exception_t(fmt::format("Failed to pin thread to CPU {}", placement_->cpu(thread_idx_)));
+
+    if (!placement_->numa_bound())
+        return;
+    nodes_mask_t nodes {};
+    size_t node = placement_->node(thread_idx_);
+    nodes[node / (8 * sizeof(unsigned long))] |= 1ul << (node % (8 * sizeof(unsigned long)));
+    // Note: The kernel ignores the last bit of the mask
+    if (syscall(SYS_set_mempolicy, MPOL_BIND, nodes.data(), nodes_mask_bits_k + 1) != 0)
+        throw exception_t(fmt::format("Failed to bind memory to NUMA node {}", node));
+}
+
+inline void thread_placement_guard_t::restore() noexcept {
+    if (!placement_->pinned())
+        return;
+    pthread_setaffinity_np(pthread_self(), sizeof(original_cpus_), &original_cpus_);
+    if (placement_->numa_bound()) {
+        bool has_nodes = original_policy_ != MPOL_DEFAULT && original_policy_ != MPOL_LOCAL;
+        unsigned long const* nodes = has_nodes ? original_nodes_.data() : nullptr;
+        syscall(SYS_set_mempolicy, original_policy_, nodes, nodes_mask_bits_k + 1);
+    }
+}
+
+} // namespace ucsb
@@ -19,6 +19,10 @@ struct printable_duration_t {
     size_t duration = 0; // In milliseconds
 };
 
+struct printable_latency_t {
+    size_t latency = 0; // In nanoseconds
+};
+
 } // namespace ucsb
 
 template <>
@@ -204,4 +208,31 @@ class fmt::formatter<ucsb::printable_duration_t> {
 
         return fmt::format_to(ctx.out(), "{}", str_duration);
     }
-};
\ No newline at end of file
+};
+
+template <>
+class fmt::formatter<ucsb::printable_latency_t> {
+  public:
+    template <typename ctx_at>
+    constexpr auto parse(ctx_at& ctx) {
+        return ctx.begin();
+    }
+
+    template <typename ctx_at>
+    auto format(ucsb::printable_latency_t const& v, ctx_at& ctx) {
+
+        char const* suffix_k[] = {"ns", "us", "ms", "s"};
+
+        double latency = v.latency;
+        size_t suffix_idx = 0;
+        char const length = sizeof(suffix_k) / sizeof(suffix_k[0]);
+        while (latency >= 1'000.0 && suffix_idx < length - 1) {
+            ++suffix_idx;
+            latency /= 1'000.0;
+        }
+
+        if (suffix_idx == 0)
+            return fmt::format_to(ctx.out(), "{}{}", v.latency, suffix_k[suffix_idx]);
+        return fmt::format_to(ctx.out(), "{:.2f}{}", latency, suffix_k[suffix_idx]);
+    }
+};
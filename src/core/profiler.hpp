@@ -1,27 +1,83 @@
 #pragma once
 
 #include <sys/times.h>
+#include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
 #include <string>
-#include <fstream>
+#include <unordered_map>
+#include <algorithm>
 #include <limits>
 #include <chrono>
 #include <thread>
 #include <atomic>
 
+#include "src/core/thread_roles.hpp"
+
 namespace ucsb {
 
+/**
+ * @brief Parses a decimal number in place, skipping leading spaces.
+ */
+inline size_t parse_proc_number(char const*& it) noexcept {
+    while (*it == ' ')
+        ++it;
+    size_t number = 0;
+    for (; *it >= '0' && *it <= '9'; ++it)
+        number = number * 10 + (*it - '0');
+    return number;
+}
+
+/**
+ * @brief Parses numeric fields of a null-terminated "/proc/.../stat" file without allocations.
+ * @param fields Ascending 1-based field numbers, as listed in proc(5), starting from the 3rd.
+ * @return False, if the file is truncated.
+ */
+template <size_t count_ak>
+inline bool parse_proc_stat(char const* buffer,
+                            size_t length,
+                            std::array<size_t, count_ak> const& fields,
+                            std::array<size_t, count_ak>& values) noexcept {
+    // Note: The command name may contain spaces and parentheses, so skip till the last ')'
+    char const* it = buffer + length;
+    while (it != buffer && *it != ')')
+        --it;
+    if (*it != ')')
+        return false;
+    ++it;
+
+    size_t idx = 0;
+    for (size_t field = 3; idx != count_ak && *it; ++field) {
+        while (*it == ' ')
+            ++it;
+        if (field == fields[idx])
+            values[idx++] = parse_proc_number(it);
+        else
+            while (*it && *it != ' ')
+                ++it;
+    }
+    return idx == count_ak;
+}
+
 /**
  * @brief Manages a sibling thread, that samples CPU time and real time from OS.
  * Uses similar methodology to Python package `psutil`, to estimate CPU load
  * from the aforementioned timers.
+ * Additionally walks "/proc/self/task/<tid>/stat" to attribute CPU time to thread roles:
+ * UCSB workers, UCSB profilers and everything else, i.e. DB background threads.
+ * Threads, that exit during the workload, keep the time observed by the last walk.
  *
  * @see psutil: https://pypi.org/project/psutil/
  */
 class cpu_profiler_t {
   public:
     inline cpu_profiler_t(size_t request_delay = 100)
-        : time_to_die_(true), request_delay_(request_delay), requests_count_(0) {}
+        : time_to_die_(true), last_percent_(0), request_delay_(request_delay), requests_count_(0),
+          ticks_per_second_(sysconf(_SC_CLK_TCK)) {}
     ~cpu_profiler_t() { stop(); }
 
     struct stats_t {
@@ -30,6 +86,17 @@ class cpu_profiler_t {
         float avg = 0;
     };
 
+    struct roles_time_t {
+        // CPU seconds spent by each thread role
+        std::array<double, thread_roles_t::roles_count_k> seconds {};
+        double wall_seconds = 0;
+
+        inline double cpu_seconds(thread_role_t role) const noexcept { return seconds[size_t(role)]; }
+        inline double cores(thread_role_t role) const noexcept {
+            return wall_seconds > 0 ? seconds[size_t(role)] / wall_seconds : 0.0;
+        }
+    };
+
     inline void start() {
         if (!time_to_die_.load())
             return;
@@ -38,7 +105,14 @@ class cpu_profiler_t {
         stats_.max = 0;
         stats_.avg = 0;
 
+        // Note: The first walk only remembers the time threads have already spent
+        threads_ticks_.clear();
+        walk_threads();
+        roles_ticks_.fill(0);
+        start_time_ = std::chrono::steady_clock::now();
+
         requests_count_ = 0;
+        last_percent_.store(0);
         time_to_die_.store(false);
         thread_ = std::thread(&cpu_profiler_t::request_cpu_usage, this);
     }
@@ -51,9 +125,21 @@ class cpu_profiler_t {
 
         time_to_die_.store(true);
         thread_.join();
+
+        walk_threads();
+        stop_time_ = std::chrono::steady_clock::now();
     }
 
     inline stats_t percent() const { return stats_; }
+    inline roles_time_t roles_time() const {
+        roles_time_t time;
+        for (size_t idx = 0; idx != thread_roles_t::roles_count_k; ++idx)
+            time.seconds[idx] = double(roles_ticks_[idx]) / ticks_per_second_;
+        time.wall_seconds = std::chrono::duration<double>(stop_time_ - start_time_).count();
+        return time;
+    }
+    // Note: Can be called concurrently with sampling
+    inline float last_percent() const { return last_percent_.load(std::memory_order_relaxed); }
 
   private:
     inline void recalculate(float percent) {
@@ -62,7 +148,44 @@ class cpu_profiler_t {
         stats_.avg = (stats_.avg * (requests_count_ - 1) + percent) / requests_count_;
     }
 
+    inline void walk_threads() {
+        DIR* dir = opendir("/proc/self/task");
+        if (!dir)
+            return;
+
+        char path[64];
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] < '0' || entry->d_name[0] > '9')
+                continue;
+            pid_t tid = atoi(entry->d_name);
+            snprintf(path, sizeof(path), "/proc/self/task/%d/stat", tid);
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                continue;
+            ssize_t length = read(fd, buffer_.data(), buffer_.size() - 1);
+            close(fd);
+            if (length <= 0)
+                continue;
+            buffer_[length] = '\0';
+
+            // User time, system time
+            constexpr std::array<size_t, 2> fields {14, 15};
+            std::array<size_t, 2> values {};
+            if (!parse_proc_stat(buffer_.data(), length, fields, values))
+                continue;
+
+            // Note: A smaller value means the thread ID was reused by a new thread
+            size_t ticks = values[0] + values[1];
+            size_t& last_ticks = threads_ticks_[tid];
+            size_t delta = ticks >= last_ticks ? ticks - last_ticks : ticks;
+            roles_ticks_[size_t(thread_roles_t::role(tid))] += delta;
+            last_ticks = ticks;
+        }
+        closedir(dir);
+    }
+
     void request_cpu_usage() {
+        thread_role_guard_t role_guard(thread_role_t::profiler_k);
         bool first_time = true;
         clock_t last_cpu = 0;
         clock_t last_proc_user = 0;
@@ -80,6 +203,7 @@ class cpu_profiler_t {
                 float percent = 100.0 * delta_proc / delta_cpu;
                 ++requests_count_;
                 recalculate(percent);
+                last_percent_.store(percent, std::memory_order_relaxed);
             }
             else
                 first_time = false;
@@ -87,6 +211,7 @@ class cpu_profiler_t {
             last_cpu = cpu;
             last_proc_user = proc_user;
             last_proc_sys = proc_sys;
+            walk_threads();
 
             std::this_thread::sleep_for(std::chrono::milliseconds(request_delay_));
         }
@@ -96,23 +221,37 @@ class cpu_profiler_t {
     std::atomic_bool time_to_die_;
 
     stats_t stats_;
+    std::atomic<float> last_percent_;
     size_t request_delay_;
     size_t requests_count_;
+
+    size_t ticks_per_second_;
+    std::unordered_map<pid_t, size_t> threads_ticks_;
+    std::array<size_t, thread_roles_t::roles_count_k> roles_ticks_ {};
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point stop_time_;
+    // Note: Only used by the sampling thread, or when it's not running
+    std::array<char, 1024> buffer_;
 };
 
 /**
- * @brief Manages a sibling thread, that sample the virtual "/proc/self/stat" file
- * to estimate memory usage stats of the current process, similar to Valgrind.
- * Collects both Resident Set Size and Virtual Memory Size.
- * ! To avoid reimplementing STL for a purposes of benchmark, this uses `std::ifstream`
- * ! and does numerous heap allocations. Not a recommended practice :)
+ * @brief Manages a sibling thread, that samples the virtual "/proc/self/stat" and
+ * "/proc/self/smaps_rollup" files to estimate memory usage stats of the current process,
+ * similar to Valgrind. Collects Resident Set Size, split into anonymous, file-backed and
+ * shared pages, Virtual Memory Size and the number of minor and major page faults.
+ * Files are kept open and re-read with `pread` into a fixed buffer, so sampling does
+ * no heap allocations inside the measured window.
+ * Note: Reading "smaps_rollup" walks the page tables, so it's more expensive for
+ * processes with huge mappings, prefer longer request delays for those.
  *
  * @see valgrind: https://valgrind.org/
  */
 class mem_profiler_t {
   public:
     inline mem_profiler_t(size_t request_delay = 100)
-        : time_to_die_(true), request_delay_(request_delay), requests_count_(0), page_size_(sysconf(_SC_PAGE_SIZE)) {}
+        : time_to_die_(true), last_vm_(0), last_rss_(0), last_rss_anon_(0), last_rss_file_(0),
+          last_minor_faults_(0), last_major_faults_(0), request_delay_(request_delay), requests_count_(0),
+          page_size_(sysconf(_SC_PAGE_SIZE)), stat_fd_(-1), smaps_fd_(-1) {}
     ~mem_profiler_t() { stop(); }
 
     struct stats_t {
@@ -125,15 +264,27 @@ class mem_profiler_t {
         if (!time_to_die_.load())
             return;
 
-        stats_vms_.min = std::numeric_limits<size_t>::max();
-        stats_vms_.max = 0;
-        stats_vms_.avg = 0;
+        stats_vms_ = stats_t {};
+        stats_rss_ = stats_t {};
+        stats_rss_anon_ = stats_t {};
+        stats_rss_file_ = stats_t {};
+        stats_rss_shared_ = stats_t {};
 
-        stats_rss_.min = std::numeric_limits<size_t>::max();
-        stats_rss_.max = 0;
-        stats_rss_.avg = 0;
+        stat_fd_ = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+        smaps_fd_ = open("/proc/self/smaps_rollup", O_RDONLY | O_CLOEXEC);
+        has_smaps_ = smaps_fd_ >= 0;
+        sample_t sample;
+        read_stat(sample);
+        start_minor_faults_ = sample.minor_faults;
+        start_major_faults_ = sample.major_faults;
 
         requests_count_ = 0;
+        last_vm_.store(0);
+        last_rss_.store(0);
+        last_rss_anon_.store(0);
+        last_rss_file_.store(0);
+        last_minor_faults_.store(0);
+        last_major_faults_.store(0);
         time_to_die_.store(false);
         thread_ = std::thread(&mem_profiler_t::request_mem_usage, this);
     }
@@ -143,47 +294,130 @@ class mem_profiler_t {
 
         time_to_die_.store(true);
         thread_.join();
+
+        // One more sample, so that faults are counted till the very end
+        sample();
+        for (int* fd : {&stat_fd_, &smaps_fd_}) {
+            if (*fd >= 0)
+                close(*fd);
+            *fd = -1;
+        }
     }
 
     inline stats_t vm() const { return stats_vms_; }
     inline stats_t rss() const { return stats_rss_; }
+    inline stats_t rss_anon() const { return stats_rss_anon_; }
+    inline stats_t rss_file() const { return stats_rss_file_; }
+    inline stats_t rss_shared() const { return stats_rss_shared_; }
+    // Note: "smaps_rollup" is available since Linux 4.14
+    inline bool has_rss_details() const { return has_smaps_; }
+    // Note: Faults since `start()`
+    inline size_t minor_faults() const { return last_minor_faults_.load(std::memory_order_relaxed); }
+    inline size_t major_faults() const { return last_major_faults_.load(std::memory_order_relaxed); }
+    // Note: Can be called concurrently with sampling
+    inline size_t last_vm() const { return last_vm_.load(std::memory_order_relaxed); }
+    inline size_t last_rss() const { return last_rss_.load(std::memory_order_relaxed); }
+    inline size_t last_rss_anon() const { return last_rss_anon_.load(std::memory_order_relaxed); }
+    inline size_t last_rss_file() const { return last_rss_file_.load(std::memory_order_relaxed); }
 
   private:
-    inline void recalculate(size_t vm, size_t rss) {
-        stats_vms_.min = std::min(vm, stats_vms_.min);
-        stats_vms_.max = std::max(vm, stats_vms_.max);
-        stats_vms_.avg = (stats_vms_.avg * (requests_count_ - 1) + vm) / requests_count_;
-
-        stats_rss_.min = std::min(rss, stats_rss_.min);
-        stats_rss_.max = std::max(rss, stats_rss_.max);
-        stats_rss_.avg = (stats_rss_.avg * (requests_count_ - 1) + rss) / requests_count_;
+    struct sample_t {
+        size_t vm = 0;
+        size_t rss = 0;
+        size_t rss_anon = 0;
+        size_t rss_file = 0;
+        size_t rss_shared = 0;
+        size_t minor_faults = 0;
+        size_t major_faults = 0;
+    };
+
+    static constexpr size_t buffer_size_k = 4096;
+
+    static inline void recalculate(stats_t& stats, size_t value, size_t count) {
+        stats.min = std::min(value, stats.min);
+        stats.max = std::max(value, stats.max);
+        stats.avg = (stats.avg * (count - 1) + value) / count;
     }
 
     inline void request_mem_usage() {
+        thread_role_guard_t role_guard(thread_role_t::profiler_k);
         while (!time_to_die_.load(std::memory_order_relaxed)) {
-            size_t vm = 0, rss = 0;
-            mem_usage(vm, rss);
-            ++requests_count_;
-            recalculate(vm, rss);
+            sample();
             std::this_thread::sleep_for(std::chrono::milliseconds(request_delay_));
         }
     }
 
-    inline void mem_usage(size_t& vm, size_t& rss) {
-        vm = 0;
-        rss = 0;
-
-        std::ifstream stat("/proc/self/stat", std::ios_base::in);
-        std::string pid, comm, state, ppid, pgrp, session, tty_nr;
-        std::string tpgid, flags, minflt, cminflt, majflt, cmajflt;
-        std::string utime, stime, cutime, cstime, priority, nice;
-        std::string num_threads, itrealvalue, starttime;
-        stat >> pid >> comm >> state >> ppid >> pgrp >> session >> tty_nr >> tpgid >> flags >> minflt >> cminflt >>
-            majflt >> cmajflt >> utime >> stime >> cutime >> cstime >> priority >> nice >> num_threads >> itrealvalue >>
-            starttime >> vm >> rss;
-        stat.close();
-
-        rss = rss * page_size_;
+    inline void sample() {
+        sample_t sample;
+        read_stat(sample);
+        read_smaps_rollup(sample);
+
+        ++requests_count_;
+        recalculate(stats_vms_, sample.vm, requests_count_);
+        recalculate(stats_rss_, sample.rss, requests_count_);
+        recalculate(stats_rss_anon_, sample.rss_anon, requests_count_);
+        recalculate(stats_rss_file_, sample.rss_file, requests_count_);
+        recalculate(stats_rss_shared_, sample.rss_shared, requests_count_);
+        last_vm_.store(sample.vm, std::memory_order_relaxed);
+        last_rss_.store(sample.rss, std::memory_order_relaxed);
+        last_rss_anon_.store(sample.rss_anon, std::memory_order_relaxed);
+        last_rss_file_.store(sample.rss_file, std::memory_order_relaxed);
+        last_minor_faults_.store(sample.minor_faults - start_minor_faults_, std::memory_order_relaxed);
+        last_major_faults_.store(sample.major_faults - start_major_faults_, std::memory_order_relaxed);
+    }
+
+    inline size_t read_file(int fd) {
+        if (fd < 0)
+            return 0;
+        ssize_t length = pread(fd, buffer_.data(), buffer_.size() - 1, 0);
+        length = std::max(length, ssize_t(0));
+        buffer_[length] = '\0';
+        return length;
+    }
+
+    inline void read_stat(sample_t& sample) {
+        size_t length = read_file(stat_fd_);
+        // Minor faults, major faults, virtual size, resident pages
+        constexpr std::array<size_t, 4> fields {10, 12, 23, 24};
+        std::array<size_t, 4> values {};
+        if (!parse_proc_stat(buffer_.data(), length, fields, values))
+            return;
+        sample.minor_faults = values[0];
+        sample.major_faults = values[1];
+        sample.vm = values[2];
+        sample.rss = values[3] * page_size_;
+    }
+
+    inline void read_smaps_rollup(sample_t& sample) {
+        size_t length = read_file(smaps_fd_);
+        if (!length)
+            return;
+
+        // Note: All values are in kB, the first line describes the rollup mapping
+        size_t rss = 0, anonymous = 0, shared = 0;
+        char const* it = buffer_.data();
+        while (*it) {
+            auto starts_with = [&](char const* prefix, size_t prefix_length) {
+                if (strncmp(it, prefix, prefix_length) != 0)
+                    return false;
+                it += prefix_length;
+                return true;
+            };
+            if (starts_with("Rss:", 4))
+                rss = parse_proc_number(it);
+            else if (starts_with("Anonymous:", 10))
+                anonymous = parse_proc_number(it);
+            else if (starts_with("Shared_Clean:", 13) || starts_with("Shared_Dirty:", 13))
+                shared += parse_proc_number(it);
+            while (*it && *it != '\n')
+                ++it;
+            if (*it)
+                ++it;
+        }
+
+        sample.rss_anon = anonymous * 1024;
+        sample.rss_file = (rss - std::min(rss, anonymous)) * 1024;
+        sample.rss_shared = shared * 1024;
     }
 
     std::thread thread_;
@@ -191,10 +425,27 @@ class mem_profiler_t {
 
     stats_t stats_vms_;
     stats_t stats_rss_;
+    stats_t stats_rss_anon_;
+    stats_t stats_rss_file_;
+    stats_t stats_rss_shared_;
+    std::atomic_size_t last_vm_;
+    std::atomic_size_t last_rss_;
+    std::atomic_size_t last_rss_anon_;
+    std::atomic_size_t last_rss_file_;
+    std::atomic_size_t last_minor_faults_;
+    std::atomic_size_t last_major_faults_;
 
     size_t request_delay_;
     size_t requests_count_;
     size_t page_size_;
+
+    int stat_fd_;
+    int smaps_fd_;
+    bool has_smaps_ = false;
+    size_t start_minor_faults_ = 0;
+    size_t start_major_faults_ = 0;
+    // Note: Only used by the sampling thread, or after it's joined
+    std::array<char, buffer_size_k> buffer_;
 };
 
-} // namespace ucsb
\ No newline at end of file
+} // namespace ucsb
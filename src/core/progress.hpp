@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <algorithm>
+
+#include <fmt/format.h>
+#include <fmt/color.h>
+
+#include "src/core/timer.hpp"
+#include "src/core/printable.hpp"
+#include "src/core/thread_stats.hpp"
+#include "src/core/thread_roles.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Manages a sibling thread, that aggregates the progress counters
+ * of all worker threads and renders the progress line.
+ * Workers only increment their own counters, so neither the accounting
+ * nor the printing happens on the hot path.
+ */
+class progress_t {
+  public:
+    inline progress_t(threads_stats_t const& threads_stats, size_t request_delay = 100)
+        : threads_stats_(&threads_stats), time_to_die_(true), request_delay_(request_delay) {}
+    ~progress_t() { stop(); }
+
+    /**
+     * @brief Starts monitoring, planned operations of all workers must be set before this call.
+     * @param threads_count Number of workers, to average their measured time over, same as in results.
+     * @param duration_s Wall-clock limit of the workload, if any, whichever comes first.
+     */
+    inline void start(std::string const& workload_name, size_t threads_count, double duration_s = 0) {
+        if (!time_to_die_.load())
+            return;
+
+        workload_name_ = workload_name;
+        threads_count_ = std::max(threads_count, size_t(1));
+        duration_ = seconds_to_duration(duration_s);
+        total_operations_ = 0;
+        for (auto const& thread_stats : *threads_stats_)
+            total_operations_ += atomic_load(thread_stats.planned_operations);
+        last_printed_operations_ = 0;
+        prev_ops_per_second_ = 0;
+        start_time_ = high_resolution_clock_t::now();
+        last_print_time_ = start_time_;
+
+        print_start();
+        time_to_die_.store(false);
+        thread_ = std::thread(&progress_t::request_progress, this);
+    }
+    inline void stop() {
+        if (time_to_die_.load())
+            return;
+
+        time_to_die_.store(true);
+        thread_.join();
+        print_end();
+    }
+
+    static void print_db_open() {
+        fmt::print("\33[2K\r");
+        fmt::print(" [✱] Opening DB...\r");
+        fflush(stdout);
+    }
+
+    static void print_db_close() {
+        fmt::print("\33[2K\r");
+        fmt::print(" [✱] Closing DB...\r");
+        fflush(stdout);
+    }
+
+    static void print_warmup(std::string const& workload_name) {
+        fmt::print("\33[2K\r");
+        auto name = fmt::format(fmt::fg(fmt::color::light_green), "{}", workload_name);
+        fmt::print(" [✱] {}: Warming up...\r", name);
+        fflush(stdout);
+    }
+
+    static void print_db_flush() {
+        fmt::print("\33[2K\r");
+        fmt::print(" [✱] Flushing DB...\r");
+        fflush(stdout);
+    }
+
+    static void clear_last_print() {
+        fmt::print("\33[2K\r");
+        fflush(stdout);
+    }
+
+  private:
+    inline void request_progress() {
+        thread_role_guard_t role_guard(thread_role_t::profiler_k);
+        // Note: Once all operations are done, the line belongs to the flushing thread
+        bool done = false;
+        while (!time_to_die_.load(std::memory_order_relaxed) && !done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(request_delay_));
+
+            thread_stats_t::counters_t total;
+            for (auto const& thread_stats : *threads_stats_)
+                total.merge(thread_stats.counters);
+            auto now = high_resolution_clock_t::now();
+            bool time_is_up = duration_.count() && now - start_time_ >= duration_;
+            done = total.done_operations >= total_operations_ || time_is_up;
+
+            auto print_operations_step = std::max(size_t(0.05 * total_operations_), size_t(1));
+            bool is_time_to_print = total.done_operations - last_printed_operations_ >= print_operations_step ||
+                                    now - last_print_time_ >= std::chrono::seconds(1) || done;
+            if (is_time_to_print && total.done_operations) {
+                print(total, now);
+                last_printed_operations_ = total.done_operations;
+                last_print_time_ = now;
+            }
+        }
+    }
+
+    inline void print_start() {
+        fmt::print("\33[2K\r");
+        auto name = fmt::format(fmt::fg(fmt::color::light_green), "{}", workload_name_);
+        fmt::print(" [✱] {}: 0.00%\r", name, 0.0);
+        fflush(stdout);
+    }
+
+    inline void print_end() {
+        fmt::print("\33[2K\r");
+        fmt::print(" [✱] Completed\r");
+        fflush(stdout);
+    }
+
+    inline void print(thread_stats_t::counters_t const& total, time_point_t now) {
+
+        auto elapsed_time = now - start_time_;
+        auto done_percent = 100.f * total.done_operations / total_operations_;
+        if (duration_.count())
+            done_percent = std::max(done_percent, 100.f * elapsed_time_t(elapsed_time).count() / duration_.count());
+        done_percent = std::min(done_percent, 100.f);
+        auto fails_percent = total.failed_operations * 100.0 / total.done_operations;
+        // Note: Over the time workers measured, so it converges to the result, unlike the wall time
+        double operations_s = total.operations_ns / 1e9 / threads_count_;
+        auto ops_per_second = operations_s > 0 ? total.entries_touched / operations_s : 0.0;
+        auto opps_delta = int64_t(ops_per_second) - prev_ops_per_second_;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_time).count();
+        auto remaining = std::chrono::milliseconds(size_t((elapsed / done_percent) * (100.f - done_percent))).count();
+
+        fmt::print("\33[2K\r");
+        auto name = fmt::format(fmt::fg(fmt::color::light_green), "{}", workload_name_);
+        std::string delta;
+        if (opps_delta < 0 && std::abs(opps_delta) > prev_ops_per_second_ * 0.0001)
+            delta = fmt::format(fmt::fg(fmt::color::red), "▼");
+        else if (opps_delta > 0 && std::abs(opps_delta) > prev_ops_per_second_ * 0.0001)
+            delta = fmt::format(fmt::fg(fmt::color::green), "▲");
+        auto fails = fails_percent == 0.0 ? fmt::format("{:g}%", fails_percent)
+                                          : fmt::format(fmt::fg(fmt::color::red), "{:g}%", fails_percent);
+        fmt::print(" [✱] {}: {:.2f}% [{}/s {}| fails: {} | elapsed: {} | left: {}]\r",
+                   name,
+                   done_percent,
+                   printable_float_t {ops_per_second},
+                   delta,
+                   fails,
+                   printable_duration_t {size_t(elapsed)},
+                   printable_duration_t {size_t(remaining)});
+        fflush(stdout);
+
+        prev_ops_per_second_ = int64_t(ops_per_second);
+    }
+
+    threads_stats_t const* threads_stats_;
+
+    std::thread thread_;
+    std::atomic_bool time_to_die_;
+    size_t request_delay_;
+
+    std::string workload_name_;
+    size_t threads_count_ = 1;
+    size_t total_operations_;
+    elapsed_time_t duration_;
+    size_t last_printed_operations_;
+    int64_t prev_ops_per_second_;
+    time_point_t start_time_;
+    time_point_t last_print_time_;
+};
+
+} // namespace ucsb
@@ -19,6 +19,53 @@ namespace ucsb {
 namespace bm = benchmark;
 namespace fs = ucsb::fs;
 
+/**
+ * @brief Names benchmarks of thread-count sweeps, like "Read(threads:4)".
+ */
+inline std::string sweep_benchmark_name(std::string const& workload_name, size_t threads_count) {
+    return fmt::format("{}(threads:{})", workload_name, threads_count);
+}
+
+/**
+ * @brief The workload of a benchmark of a thread-count sweep, or an empty string for other benchmarks.
+ */
+inline std::string sweep_workload_name(std::string const& benchmark_name) {
+    size_t pos = benchmark_name.find("(threads:");
+    return pos != std::string::npos ? benchmark_name.substr(0, pos) : std::string();
+}
+
+/**
+ * @brief Parallel efficiency of benchmarks of thread-count sweeps, which is the throughput per thread
+ * relative to the one of the benchmark of the same sweep, run with the fewest threads.
+ */
+class parallel_efficiency_t {
+  public:
+    inline void add_baseline(std::string const& workload_name, size_t threads_count, double throughput) {
+        baseline_t baseline {threads_count, throughput / threads_count};
+        auto [it, added] = baselines_.try_emplace(workload_name, baseline);
+        if (!added && threads_count < it->second.threads_count)
+            it->second = baseline;
+    }
+    inline double percent(std::string const& workload_name, size_t threads_count, double throughput) const {
+        auto it = baselines_.find(workload_name);
+        if (it == baselines_.end() || it->second.throughput_per_thread <= 0)
+            return 0.0;
+        return throughput / threads_count * 100.0 / it->second.throughput_per_thread;
+    }
+    // Note: Sweeps run with ascending numbers of threads, so the baseline always comes first
+    inline double add(std::string const& workload_name, size_t threads_count, double throughput) {
+        add_baseline(workload_name, threads_count, throughput);
+        return percent(workload_name, threads_count, throughput);
+    }
+
+  private:
+    struct baseline_t {
+        size_t threads_count = 0;
+        double throughput_per_thread = 0;
+    };
+    std::unordered_map<std::string, baseline_t> baselines_;
+};
+
 class console_reporter_t : public bm::BenchmarkReporter {
 
     using base_t = bm::BenchmarkReporter;
@@ -33,7 +80,13 @@ class console_reporter_t : public bm::BenchmarkReporter {
     };
 
   public:
-    inline console_reporter_t(std::string const& title, sections_t sections);
+    /**
+     * @param ceilings Throughputs of the same workloads on the `null` DB, if available.
+     * Every result is then also shown as a share of this harness ceiling.
+     */
+    inline console_reporter_t(std::string const& title,
+                              sections_t sections,
+                              std::unordered_map<std::string, double> const& ceilings = {});
 
   public:
     // Prints environment information
@@ -49,6 +102,8 @@ class console_reporter_t : public bm::BenchmarkReporter {
   private:
     std::string title_;
     sections_t sections_;
+    std::unordered_map<std::string, double> ceilings_;
+    parallel_efficiency_t efficiency_;
     bool has_header_printed_;
 
     tabulate::Table::Row_t columns_;
@@ -58,24 +113,36 @@ class console_reporter_t : public bm::BenchmarkReporter {
     size_t columns_total_width_;
 };
 
-inline console_reporter_t::console_reporter_t(std::string const& title, sections_t sections)
-    : base_t(), title_(title), sections_(sections), has_header_printed_(true), fails_column_idx_(0), column_width_(0),
-      workload_column_width_(0), columns_total_width_(0) {
+inline console_reporter_t::console_reporter_t(std::string const& title,
+                                              sections_t sections,
+                                              std::unordered_map<std::string, double> const& ceilings)
+    : base_t(), title_(title), sections_(sections), ceilings_(ceilings), has_header_printed_(true), fails_column_idx_(0),
+      column_width_(0), workload_column_width_(0), columns_total_width_(0) {
 
     columns_ = {
         "Workload",
         "Throughput",
+        "Ceiling (%)",
+        "Scaling (%)",
+        "Lat (p50)",
+        "Lat (p99)",
+        "Lat (p99.9)",
+        "Lat (max)",
         "Data Processed",
         "Disk Usage",
+        "Write Amp",
         "Memory (avg)",
         "Memory (max)",
         "CPU (avg,%)",
         "CPU (max,%)",
+        "IPC",
+        "Cycles/op",
+        "LLC miss/op",
         "Fails (%)",
         "Duration",
     };
 
-    fails_column_idx_ = 8;
+    fails_column_idx_ = 18;
 
     column_width_ = 13;
     workload_column_width_ = 18;
@@ -126,15 +193,41 @@ void console_reporter_t::ReportRuns(std::vector<Run> const& reports) {
 
         // Counters
         double throughput = report.counters.at("operations/s").value;
+        auto ceiling = ceilings_.find(report.run_name.function_name);
+        std::string ceiling_percent = "-";
+        if (ceiling != ceilings_.end() && ceiling->second > 0)
+            ceiling_percent = fmt::format("{:.1f}", throughput * 100.0 / ceiling->second);
+        auto sweep_workload = sweep_workload_name(report.run_name.function_name);
+        std::string efficiency_percent = "-";
+        if (!sweep_workload.empty())
+            efficiency_percent = fmt::format("{:.1f}", efficiency_.add(sweep_workload, report.threads, throughput));
+        size_t latency_p50 = report.counters.at("latency_p50,ns").value;
+        size_t latency_p99 = report.counters.at("latency_p99,ns").value;
+        size_t latency_p999 = report.counters.at("latency_p99.9,ns").value;
+        size_t latency_max = report.counters.at("latency_max,ns").value;
         //
         size_t data_processed = report.counters.at("processed,bytes").value;
         size_t disk_usage = report.counters.at("disk,bytes").value;
+        // Note: Only available, if the DB directories are backed by block devices
+        auto write_amplification_it = report.counters.find("write_amplification");
+        auto write_amplification = write_amplification_it != report.counters.end()
+                                       ? fmt::format("{:.2f}", write_amplification_it->second.value)
+                                       : std::string("-");
         //
         size_t mem_avg = report.counters.at("mem_avg(rss),bytes").value;
         size_t mem_max = report.counters.at("mem_max(rss),bytes").value;
         double cpu_avg = report.counters.at("cpu_avg,%").value;
         double cpu_max = report.counters.at("cpu_max,%").value;
         //
+        // Note: Hardware counters are optional
+        auto hw_counter = [&](std::string const& name, char const* format) {
+            auto it = report.counters.find(name);
+            return it != report.counters.end() ? fmt::format(fmt::runtime(format), it->second.value) : "-";
+        };
+        auto ipc = hw_counter("ipc", "{:.2f}");
+        auto cycles = hw_counter("cycles/op", "{:.0f}");
+        auto llc_misses = hw_counter("llc_misses/op", "{:.2f}");
+        //
         double fails = report.counters.at("fails,%").value;
         double duration =
             convert_duration(report.real_accumulated_time, bm::TimeUnit::kSecond, bm::TimeUnit::kMillisecond);
@@ -143,12 +236,22 @@ void console_reporter_t::ReportRuns(std::vector<Run> const& reports) {
         tabulate::Table table;
         table.add_row({report.run_name.function_name,
                        fmt::format("{}/s", printable_float_t {throughput}),
+                       ceiling_percent,
+                       efficiency_percent,
+                       fmt::format("{}", printable_latency_t {latency_p50}),
+                       fmt::format("{}", printable_latency_t {latency_p99}),
+                       fmt::format("{}", printable_latency_t {latency_p999}),
+                       fmt::format("{}", printable_latency_t {latency_max}),
                        fmt::format("{}", printable_bytes_t {data_processed}),
                        fmt::format("{}", printable_bytes_t {disk_usage}),
+                       write_amplification,
                        fmt::format("{}", printable_bytes_t {mem_avg}),
                        fmt::format("{}", printable_bytes_t {mem_max}),
                        fmt::format("{:.1f}", cpu_avg),
                        fmt::format("{:.1f}", cpu_max),
+                       ipc,
+                       cycles,
+                       llc_misses,
                        fmt::format("{:g}", fails),
                        fmt::format("{}", printable_duration_t {size_t(duration)})});
         table.row(0).format().width(column_width_).font_align(tabulate::FontAlign::right).hide_border_top().locale("C");
@@ -208,6 +311,10 @@ double console_reporter_t::convert_duration(double duration, bm::TimeUnit from,
 class file_reporter_t {
   public:
     static void merge_results(fs::path const& source_file_path, fs::path const& destination_file_path);
+    /**
+     * @brief Loads the throughput of every workload from a results file.
+     */
+    static std::unordered_map<std::string, double> load_throughputs(fs::path const& file_path);
 
   private:
     static std::string parse_workload_name(std::string const& benchmark_name);
@@ -232,6 +339,22 @@ void file_reporter_t::merge_results(fs::path const& source_file_path, fs::path c
     ordered_json j_source;
     ifstream >> j_source;
 
+    // Note: Computed within this run only, older results keep the values of their own runs
+    parallel_efficiency_t efficiency;
+    for (int pass = 0; pass != 2; ++pass) {
+        for (auto& j_benchmark : j_source["benchmarks"]) {
+            auto sweep_workload = sweep_workload_name(parse_workload_name(j_benchmark["name"].get<std::string>()));
+            if (sweep_workload.empty() || !j_benchmark.contains("operations/s"))
+                continue;
+            size_t threads_count = j_benchmark["threads"].get<size_t>();
+            double throughput = j_benchmark["operations/s"].get<double>();
+            if (pass == 0)
+                efficiency.add_baseline(sweep_workload, threads_count, throughput);
+            else
+                j_benchmark["parallel_efficiency,%"] = efficiency.percent(sweep_workload, threads_count, throughput);
+        }
+    }
+
     ordered_json j_destination;
     if (fs::exists(destination_file_path)) {
         ifstream = std::ifstream(destination_file_path);
@@ -263,6 +386,8 @@ void file_reporter_t::merge_results(fs::path const& source_file_path, fs::path c
                 results.push_back(*it);
         }
         j_destination["benchmarks"] = results;
+        // Note: The context, including the placement of threads, describes the latest run
+        j_destination["context"] = j_source["context"];
     }
     else
         j_destination = j_source;
@@ -271,4 +396,25 @@ void file_reporter_t::merge_results(fs::path const& source_file_path, fs::path c
     ofstream << std::setw(2) << j_destination << std::endl;
 }
 
+std::unordered_map<std::string, double> file_reporter_t::load_throughputs(fs::path const& file_path) {
+
+    std::unordered_map<std::string, double> throughputs;
+    if (file_path.empty() || !fs::exists(file_path))
+        return throughputs;
+
+    std::ifstream ifstream(file_path);
+    ordered_json j_results;
+    ifstream >> j_results;
+
+    auto j_benchmarks = j_results["benchmarks"];
+    for (auto it = j_benchmarks.begin(); it != j_benchmarks.end(); ++it) {
+        if (!it->contains("operations/s"))
+            continue;
+        auto name = parse_workload_name((*it)["name"].get<std::string>());
+        throughputs[name] = (*it)["operations/s"].get<double>();
+    }
+
+    return throughputs;
+}
+
 } // namespace ucsb
\ No newline at end of file
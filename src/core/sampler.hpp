@@ -0,0 +1,171 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <fstream>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "src/core/types.hpp"
+#include "src/core/timer.hpp"
+#include "src/core/operation.hpp"
+#include "src/core/profiler.hpp"
+#include "src/core/thread_stats.hpp"
+#include "src/core/thread_roles.hpp"
+
+using ordered_json = nlohmann::ordered_json;
+
+namespace ucsb {
+
+/**
+ * @brief Manages a sibling thread, that periodically snapshots the statistics of all
+ * worker threads and appends the difference since the previous snapshot as a single
+ * NDJSON line: throughput and latencies per operation kind, failures, RAM and CPU usage.
+ * Workers never synchronize with it, it only reads their relaxed counters.
+ */
+class sampler_t {
+  public:
+    inline sampler_t(threads_stats_t const& threads_stats,
+                     cpu_profiler_t const& cpu_profiler,
+                     mem_profiler_t const& mem_profiler,
+                     size_t request_delay = 1000)
+        : threads_stats_(&threads_stats), cpu_profiler_(&cpu_profiler), mem_profiler_(&mem_profiler),
+          time_to_die_(true), request_delay_(request_delay) {}
+    ~sampler_t() { stop(); }
+
+    /**
+     * @brief Starts sampling into a file, which is overwritten.
+     * Worker stats must be cleared before this call.
+     */
+    inline void start(std::string const& workload_name, fs::path const& file_path) {
+        if (!time_to_die_.load() || request_delay_ == 0)
+            return;
+
+        workload_name_ = workload_name;
+        ofstream_ = std::ofstream(file_path, std::ios_base::out | std::ios_base::trunc);
+        previous_ = std::make_unique<thread_stats_t>();
+        current_ = std::make_unique<thread_stats_t>();
+        interval_ = std::make_unique<thread_stats_t>();
+        start_time_ = high_resolution_clock_t::now();
+        previous_time_ = start_time_;
+        previous_minor_faults_ = 0;
+        previous_major_faults_ = 0;
+
+        time_to_die_.store(false);
+        thread_ = std::thread(&sampler_t::request_samples, this);
+    }
+    inline void stop() {
+        if (time_to_die_.load())
+            return;
+
+        time_to_die_.store(true);
+        thread_.join();
+
+        // Flush the last partial interval
+        sample();
+        ofstream_.close();
+    }
+
+  private:
+    inline void request_samples() {
+        thread_role_guard_t role_guard(thread_role_t::profiler_k);
+        auto next_time = start_time_;
+        while (!time_to_die_.load(std::memory_order_relaxed)) {
+            next_time += std::chrono::milliseconds(request_delay_);
+            // Note: Sleep in small steps to stop promptly
+            while (!time_to_die_.load(std::memory_order_relaxed) && high_resolution_clock_t::now() < next_time)
+                std::this_thread::sleep_for(std::min(std::chrono::milliseconds(10),
+                                                     std::chrono::milliseconds(request_delay_)));
+            if (!time_to_die_.load(std::memory_order_relaxed))
+                sample();
+        }
+    }
+
+    inline void sample() {
+        auto now = high_resolution_clock_t::now();
+        current_->clear();
+        for (auto const& thread_stats : *threads_stats_)
+            current_->merge(thread_stats);
+
+        // Note: Histograms are large, so the difference goes into a buffer, reused between samples
+        thread_stats_t& interval = *interval_;
+        interval = *current_;
+        interval.subtract(*previous_);
+        std::swap(previous_, current_);
+
+        double interval_seconds = std::chrono::duration<double>(now - previous_time_).count();
+        double elapsed_seconds = std::chrono::duration<double>(now - start_time_).count();
+        previous_time_ = now;
+        if (interval_seconds <= 0)
+            return;
+
+        ordered_json j_sample;
+        j_sample["workload"] = workload_name_;
+        j_sample["time,s"] = elapsed_seconds;
+        j_sample["interval,s"] = interval_seconds;
+
+        // Note: Same as in results, operations are entries touched, while requests are calls to the DB
+        latency_histogram_t total = interval.latencies.total();
+        j_sample["operations/s"] = interval.counters.entries_touched / interval_seconds;
+        j_sample["requests/s"] = total.count() / interval_seconds;
+        j_sample["fails"] = interval.counters.failed_operations;
+        j_sample["latency_p50,ns"] = total.percentile(50.0);
+        j_sample["latency_p99,ns"] = total.percentile(99.0);
+        j_sample["latency_p99.9,ns"] = total.percentile(99.9);
+        j_sample["latency_max,ns"] = total.max();
+
+        // Note: Only the operations present in the workload so far
+        for (size_t idx = 0; idx != operations_histogram_t::operations_count_k; ++idx) {
+            auto operation = operation_kind_t(idx);
+            if (!previous_->latencies[operation].count())
+                continue;
+            auto const& histogram = interval.latencies[operation];
+            auto name = operation_name(operation);
+            j_sample[fmt::format("requests/s({})", name)] = histogram.count() / interval_seconds;
+            j_sample[fmt::format("latency_p50({}),ns", name)] = histogram.percentile(50.0);
+            j_sample[fmt::format("latency_p99({}),ns", name)] = histogram.percentile(99.0);
+            j_sample[fmt::format("latency_max({}),ns", name)] = histogram.max();
+        }
+
+        j_sample["cpu,%"] = cpu_profiler_->last_percent();
+        j_sample["mem(rss),bytes"] = mem_profiler_->last_rss();
+        j_sample["mem(vm),bytes"] = mem_profiler_->last_vm();
+        j_sample["mem(anon),bytes"] = mem_profiler_->last_rss_anon();
+        j_sample["mem(file),bytes"] = mem_profiler_->last_rss_file();
+
+        // Note: Faults are counted since the start of the workload
+        size_t minor_faults = mem_profiler_->minor_faults();
+        size_t major_faults = mem_profiler_->major_faults();
+        j_sample["faults(minor)/s"] = (minor_faults - std::min(minor_faults, previous_minor_faults_)) / interval_seconds;
+        j_sample["faults(major)/s"] = (major_faults - std::min(major_faults, previous_major_faults_)) / interval_seconds;
+        previous_minor_faults_ = minor_faults;
+        previous_major_faults_ = major_faults;
+
+        ofstream_ << j_sample.dump() << '\n';
+        ofstream_.flush();
+    }
+
+    threads_stats_t const* threads_stats_;
+    cpu_profiler_t const* cpu_profiler_;
+    mem_profiler_t const* mem_profiler_;
+
+    std::thread thread_;
+    std::atomic_bool time_to_die_;
+    size_t request_delay_;
+
+    std::string workload_name_;
+    std::ofstream ofstream_;
+    std::unique_ptr<thread_stats_t> previous_;
+    std::unique_ptr<thread_stats_t> current_;
+    std::unique_ptr<thread_stats_t> interval_;
+    time_point_t start_time_;
+    time_point_t previous_time_;
+    size_t previous_minor_faults_ = 0;
+    size_t previous_major_faults_ = 0;
+};
+
+} // namespace ucsb
@@ -16,8 +16,22 @@ struct settings_t {
     fs::path workloads_file_path;
     std::string workload_filter;
     size_t threads_count = 0;
+    // Note: Random streams of all threads and generators derive from it, so runs are reproducible
+    uint64_t seed = 0;
+    // Note: Sorted thread counts to run every workload with, instead of `threads_count`
+    std::vector<size_t> threads_sweep;
 
     fs::path results_file_path;
+    fs::path ceiling_results_file_path;
+    size_t profile_interval = 0; // In milliseconds
+    size_t sample_interval = 0;  // In milliseconds
+    bool perf_counters = false;
+    size_t pregenerate_chunk = 0; // In operations per thread
+    size_t queue_depth = 1;       // In operations per thread
+    std::string pin_threads;
+    bool numa_bind = false;
+    huge_pages_t huge_pages = huge_pages_t::none_k;
+    fs::path trace_dir_path;
     size_t run_idx = 0;
     size_t runs_count = 0;
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace ucsb {
+
+/**
+ * @brief A latency service level objective, like "p99 under 2 ms",
+ * and the bounds of the search for the highest rate that still meets it.
+ */
+struct slo_t {
+    double percentile = 99.0;
+    double latency_ms = 0;
+    double start_ops_per_second = 0;
+    double max_ops_per_second = 0;
+    size_t steps = 0;
+    double step_s = 0;
+
+    inline bool enabled() const noexcept { return latency_ms > 0; }
+    inline bool met(double latency_ns) const noexcept { return latency_ns <= latency_ms * 1'000'000; }
+};
+
+/**
+ * @brief Searches for the highest arrival rate, at which the latency percentile stays within the objective.
+ * Starting from the initial rate, it doubles the rate until the objective is missed or the maximum
+ * is reached, and then bisects between the highest passing rate and the lowest failing one.
+ * Every step runs at a single rate, so all the steps together form the latency-vs-throughput curve.
+ */
+class slo_search_t {
+  public:
+    static constexpr double growth_k = 2.0;
+
+    inline void start(slo_t const& slo) noexcept {
+        slo_ = slo;
+        rate_ = slo.start_ops_per_second;
+        rates_.assign(1, rate_);
+        passed_rate_ = 0;
+        failed_rate_ = 0;
+    }
+
+    inline double rate() const noexcept { return rate_; }
+    inline double passed_rate() const noexcept { return passed_rate_; }
+    // Note: Rates of all the steps started so far
+    inline std::vector<double> const& rates() const noexcept { return rates_; }
+
+    /**
+     * @brief Judges the step just finished at the current rate, and picks the rate of the next one.
+     * @return Whether the step met the objective.
+     */
+    inline bool step(double latency_ns) noexcept {
+        bool met = slo_.met(latency_ns);
+        if (met)
+            passed_rate_ = std::max(passed_rate_, rate_);
+        else
+            failed_rate_ = failed_rate_ ? std::min(failed_rate_, rate_) : rate_;
+
+        if (!failed_rate_)
+            rate_ = std::min(rate_ * growth_k, slo_.max_ops_per_second);
+        else
+            rate_ = passed_rate_ ? (passed_rate_ + failed_rate_) / 2 : failed_rate_ / growth_k;
+        rates_.push_back(rate_);
+        return met;
+    }
+
+  private:
+    slo_t slo_;
+    double rate_ = 0;
+    std::vector<double> rates_;
+    double passed_rate_ = 0;
+    // Note: Zero until the first failure
+    double failed_rate_ = 0;
+};
+
+} // namespace ucsb
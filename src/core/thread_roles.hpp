@@ -0,0 +1,75 @@
+#pragma once
+
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <mutex>
+#include <unordered_map>
+
+namespace ucsb {
+
+enum class thread_role_t {
+    worker_k = 0,
+    profiler_k,
+    // Note: Any thread not registered by UCSB, like DB background threads
+    background_k,
+};
+
+inline char const* thread_role_name(thread_role_t role) {
+    switch (role) {
+    case thread_role_t::worker_k: return "workers";
+    case thread_role_t::profiler_k: return "profilers";
+    case thread_role_t::background_k: return "background";
+    default: return "unknown";
+    }
+}
+
+/**
+ * @brief Process-wide registry of threads spawned by UCSB itself,
+ * so that the CPU time of all other threads can be attributed to the DB.
+ * Threads register themselves on start and unregister on exit,
+ * as thread IDs may be reused by the OS.
+ */
+class thread_roles_t {
+  public:
+    static constexpr size_t roles_count_k = size_t(thread_role_t::background_k) + 1;
+
+    static inline pid_t current_tid() { return pid_t(syscall(SYS_gettid)); }
+
+    static inline void assign(thread_role_t role, pid_t tid = current_tid()) {
+        std::lock_guard lock(mutex());
+        roles()[tid] = role;
+    }
+
+    static inline void forget(pid_t tid = current_tid()) {
+        std::lock_guard lock(mutex());
+        roles().erase(tid);
+    }
+
+    static inline thread_role_t role(pid_t tid) {
+        std::lock_guard lock(mutex());
+        auto it = roles().find(tid);
+        return it != roles().end() ? it->second : thread_role_t::background_k;
+    }
+
+  private:
+    static inline std::mutex& mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static inline std::unordered_map<pid_t, thread_role_t>& roles() {
+        static std::unordered_map<pid_t, thread_role_t> roles;
+        return roles;
+    }
+};
+
+/**
+ * @brief Registers the calling thread for the lifetime of the scope.
+ */
+class thread_role_guard_t {
+  public:
+    inline thread_role_guard_t(thread_role_t role) { thread_roles_t::assign(role); }
+    ~thread_role_guard_t() { thread_roles_t::forget(); }
+};
+
+} // namespace ucsb
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include "src/core/helper.hpp"
+#include "src/core/timer.hpp"
+#include "src/core/operation.hpp"
+#include "src/core/histogram.hpp"
+#include "src/core/perf_counters.hpp"
+#include "src/core/allocations.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Statistics of a single phase of a multi-phase workload.
+ * Entries are also counted in short windows since the start of the phase,
+ * to find out how long it takes to recover from the shift.
+ */
+struct phase_stats_t {
+    static constexpr size_t window_ms_k = 100;
+
+    size_t entries_touched = 0;
+    // Note: Written once, when the thread leaves the phase
+    size_t elapsed_ns = 0;
+    latency_histogram_t latencies;
+    std::vector<size_t> windows_entries;
+
+    // Note: Must be called before the workload starts
+    inline void prepare(double duration_s) {
+        windows_entries.assign(size_t(duration_s * 1000 / window_ms_k) + 1, 0);
+    }
+
+    // Note: Only the owning thread may call it
+    inline void record(elapsed_time_t since_start, size_t latency, size_t entries) noexcept {
+        latencies.record(latency);
+        atomic_store(entries_touched, entries_touched + entries);
+        size_t window = size_t(since_start / std::chrono::milliseconds(window_ms_k));
+        window = std::min(window, windows_entries.size() - 1);
+        atomic_store(windows_entries[window], windows_entries[window] + entries);
+    }
+    inline void finish(elapsed_time_t since_start) noexcept { atomic_store(elapsed_ns, size_t(since_start.count())); }
+
+    inline void merge(phase_stats_t const& other) noexcept {
+        entries_touched += atomic_load(other.entries_touched);
+        elapsed_ns = std::max(elapsed_ns, atomic_load(other.elapsed_ns));
+        latencies.merge(other.latencies);
+        if (windows_entries.size() < other.windows_entries.size())
+            windows_entries.resize(other.windows_entries.size(), 0);
+        for (size_t idx = 0; idx != other.windows_entries.size(); ++idx)
+            windows_entries[idx] += atomic_load(other.windows_entries[idx]);
+    }
+
+    inline void subtract(phase_stats_t const& older) noexcept {
+        entries_touched -= older.entries_touched;
+        latencies.subtract(older.latencies);
+        for (size_t idx = 0; idx != std::min(windows_entries.size(), older.windows_entries.size()); ++idx)
+            windows_entries[idx] -= older.windows_entries[idx];
+    }
+
+    inline double entries_per_second() const noexcept {
+        return elapsed_ns ? entries_touched * 1e9 / elapsed_ns : 0.0;
+    }
+
+    /**
+     * @brief Seconds since the start of the phase, until the throughput of a window first reaches
+     * 90% of the steady one, which is the median over the second half of the complete windows.
+     */
+    inline double recovery_seconds() const {
+        size_t windows_count = std::min(elapsed_ns / (window_ms_k * 1'000'000), windows_entries.size());
+        if (windows_count < 2)
+            return 0.0;
+        std::vector<size_t> steady(windows_entries.begin() + windows_count / 2,
+                                   windows_entries.begin() + windows_count);
+        std::nth_element(steady.begin(), steady.begin() + steady.size() / 2, steady.end());
+        double recovered = 0.9 * steady[steady.size() / 2];
+        size_t window = 0;
+        while (window != windows_count && windows_entries[window] < recovered)
+            ++window;
+        return window * window_ms_k / 1000.0;
+    }
+};
+
+/**
+ * @brief Statistics collected by a single worker thread.
+ * Only the owning thread writes them, using relaxed stores, so that
+ * monitoring threads can read them without adding any contention.
+ * They are merged by the first thread after the workload is over.
+ */
+struct alignas(cache_line_size_k) thread_stats_t {
+
+    /**
+     * @brief Progress counters, padded to a separate cache line
+     * to avoid false sharing between neighbouring threads.
+     */
+    struct alignas(cache_line_size_k) counters_t {
+        size_t done_operations = 0;
+        size_t failed_operations = 0;
+        size_t entries_touched = 0;
+        size_t bytes_processed = 0;
+        // Note: Read-modify-write operations are counted in both
+        size_t bytes_read = 0;
+        size_t bytes_written = 0;
+        // Note: Measured time of the thread, excluding pauses, the same as in results. Summed when merged.
+        size_t operations_ns = 0;
+
+        // Note: Only the owning thread may call it
+        inline void add_operation(operation_kind_t operation, bool success, size_t entries, size_t bytes) noexcept {
+            atomic_store(done_operations, done_operations + 1);
+            atomic_store(failed_operations, failed_operations + size_t(!success));
+            atomic_store(entries_touched, entries_touched + entries);
+            atomic_store(bytes_processed, bytes_processed + bytes);
+            if (is_read(operation))
+                atomic_store(bytes_read, bytes_read + bytes);
+            if (is_write(operation))
+                atomic_store(bytes_written, bytes_written + bytes);
+        }
+        // Note: Only the owning thread may call it
+        inline void set_operations_time(elapsed_time_t time) noexcept {
+            atomic_store(operations_ns, size_t(time.count()));
+        }
+
+        inline void merge(counters_t const& other) noexcept {
+            done_operations += atomic_load(other.done_operations);
+            failed_operations += atomic_load(other.failed_operations);
+            entries_touched += atomic_load(other.entries_touched);
+            bytes_processed += atomic_load(other.bytes_processed);
+            bytes_read += atomic_load(other.bytes_read);
+            bytes_written += atomic_load(other.bytes_written);
+            operations_ns += atomic_load(other.operations_ns);
+        }
+
+        inline void subtract(counters_t const& older) noexcept {
+            done_operations -= older.done_operations;
+            failed_operations -= older.failed_operations;
+            entries_touched -= older.entries_touched;
+            bytes_processed -= older.bytes_processed;
+            bytes_read -= older.bytes_read;
+            bytes_written -= older.bytes_written;
+            operations_ns -= older.operations_ns;
+        }
+    };
+
+    counters_t counters;
+    // Note: Written once before the workload starts
+    size_t planned_operations = 0;
+    size_t group = 0;
+    operations_histogram_t latencies;
+    batches_histogram_t batches;
+    latency_histogram_t schedule_lags;
+    // Note: Written once, after all operations of the thread are done
+    hw_counters_t hw_counters;
+    // Note: Only filled in builds, that count allocations
+    std::array<allocations_t, operations_histogram_t::operations_count_k> allocations;
+    // Note: Only filled in multi-phase workloads
+    std::vector<phase_stats_t> phases;
+
+    inline void merge(thread_stats_t const& other) noexcept {
+        counters.merge(other.counters);
+        planned_operations += atomic_load(other.planned_operations);
+        latencies.merge(other.latencies);
+        batches.merge(other.batches);
+        schedule_lags.merge(other.schedule_lags);
+        hw_counters.merge(other.hw_counters);
+        for (size_t idx = 0; idx != allocations.size(); ++idx)
+            allocations[idx].merge(other.allocations[idx]);
+        if (phases.size() < other.phases.size())
+            phases.resize(other.phases.size());
+        for (size_t idx = 0; idx != other.phases.size(); ++idx)
+            phases[idx].merge(other.phases[idx]);
+    }
+
+    inline void subtract(thread_stats_t const& older) noexcept {
+        counters.subtract(older.counters);
+        planned_operations -= older.planned_operations;
+        latencies.subtract(older.latencies);
+        batches.subtract(older.batches);
+        schedule_lags.subtract(older.schedule_lags);
+        hw_counters.subtract(older.hw_counters);
+        for (size_t idx = 0; idx != allocations.size(); ++idx)
+            allocations[idx].subtract(older.allocations[idx]);
+        for (size_t idx = 0; idx != std::min(phases.size(), older.phases.size()); ++idx)
+            phases[idx].subtract(older.phases[idx]);
+    }
+
+    inline void clear() noexcept {
+        counters = counters_t {};
+        planned_operations = 0;
+        group = 0;
+        latencies.clear();
+        batches.clear();
+        schedule_lags.clear();
+        hw_counters = hw_counters_t {};
+        allocations.fill(allocations_t {});
+        phases.clear();
+    }
+};
+
+using threads_stats_t = std::vector<thread_stats_t>;
+
+} // namespace ucsb
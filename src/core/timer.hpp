@@ -11,6 +11,10 @@ using high_resolution_clock_t = std::chrono::high_resolution_clock;
 using time_point_t = std::chrono::time_point<high_resolution_clock_t>;
 using elapsed_time_t = std::chrono::nanoseconds;
 
+inline elapsed_time_t seconds_to_duration(double seconds) {
+    return std::chrono::duration_cast<elapsed_time_t>(std::chrono::duration<double>(seconds));
+}
+
 /**
  * @brief Trivial Google Benchmark wrapper.
  * No added value here :)
@@ -26,14 +30,21 @@ class timer_t {
     inline timer_t(bm::State& bench) : bench_(&bench), state_(state_t::stopped_k) {}
 
     // Google benchmark timer methods
+    // Note: Nothing to exclude before the timer is started, e.g. during warm-up
+    // Note: Ordered so that both exclude the same time, as Google Benchmark reads the wall clock
+    // first when pausing, but last when resuming
     inline void pause() {
-        bench_->PauseTiming();
-
+        if (state_ == state_t::stopped_k)
+            return;
         assert(state_ == state_t::running_k);
         recalculate_operations_elapsed_time();
         state_ = state_t::paused_k;
+
+        bench_->PauseTiming();
     }
     inline void resume() {
+        if (state_ == state_t::stopped_k)
+            return;
         assert(state_ == state_t::paused_k);
         operations_start_time_ = high_resolution_clock_t::now();
         state_ = state_t::running_k;
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include "src/core/types.hpp"
+#include "src/core/timer.hpp"
+#include "src/core/operation.hpp"
+#include "src/core/exception.hpp"
+#include "src/core/data_accessor.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief A single operation of a trace, as it was passed to the DB.
+ * Spans point into the reader, so they are valid until the next record is read.
+ */
+struct trace_record_t {
+    operation_kind_t operation = operation_kind_t::read_k;
+    // Since the start of recording
+    elapsed_time_t time {0};
+    keys_spanc_t keys;
+    value_lengths_spanc_t value_lengths;
+    // Of range selects only
+    size_t length = 0;
+};
+
+/**
+ * @brief Binary traces of operations.
+ *
+ * @section Format.
+ * A 16 bytes header: the magic "UCSBTRC", a zero byte and a 64-bit little-endian version.
+ * It's followed by records without any framing, each starting with the operation kind byte.
+ * Then comes the time since the previous record in nanoseconds, as a varint.
+ * Batch upserts, batch reads and bulk loads then have the number of keys, as a varint,
+ * while scans have no keys at all, and the rest have a single one.
+ * Every key is a zigzag-encoded varint of its delta from the previous key in the trace,
+ * so sequential and clustered keys take a byte or two. Writes are followed by the
+ * value length of every key, and range selects by their length, all as varints.
+ *
+ * As records are variable-length, a trace is only read sequentially, but it can be
+ * mapped into memory and decoded in place, without reading it into buffers first.
+ */
+struct trace_format_t {
+    static constexpr std::array<char, 8> magic_k {'U', 'C', 'S', 'B', 'T', 'R', 'C', '\0'};
+    static constexpr uint64_t version_k = 1;
+    static constexpr size_t header_size_k = magic_k.size() + sizeof(version_k);
+    // Note: LEB128 needs up to 10 bytes for 64-bit numbers
+    static constexpr size_t varint_max_size_k = 10;
+
+    static inline uint64_t zigzag(int64_t number) noexcept { return (uint64_t(number) << 1) ^ uint64_t(number >> 63); }
+    static inline int64_t unzigzag(uint64_t number) noexcept { return int64_t(number >> 1) ^ -int64_t(number & 1); }
+};
+
+/**
+ * @brief Which of the `partitions` the record belongs to, by the hash of its first key.
+ * So replaying threads share no keys, unless batches span partitions.
+ */
+inline size_t trace_partition(trace_record_t const& record, size_t partitions) noexcept {
+    if (record.keys.empty() || partitions < 2)
+        return 0;
+    // Note: Fibonacci hashing spreads sequential keys
+    return ((record.keys.front() * 0x9E3779B97F4A7C15ull) >> 32) % partitions;
+}
+
+class trace_writer_t {
+  public:
+    // Note: Flushing in chunks keeps writes large and the buffer from growing
+    static constexpr size_t flush_threshold_k = 1024 * 1024;
+
+    inline trace_writer_t() = default;
+    inline ~trace_writer_t() { close(); }
+
+    inline void open(fs::path const& path);
+    inline void close();
+    inline bool is_open() const noexcept { return ofstream_.is_open(); }
+
+    inline void write(trace_record_t const& record);
+
+  private:
+    inline void write_varint(uint64_t number) {
+        while (number >= 0x80) {
+            buffer_.push_back(uint8_t(number) | 0x80);
+            number >>= 7;
+        }
+        buffer_.push_back(uint8_t(number));
+    }
+    inline void flush() {
+        ofstream_.write(reinterpret_cast<char const*>(buffer_.data()), buffer_.size());
+        buffer_.clear();
+    }
+
+    std::ofstream ofstream_;
+    std::vector<uint8_t> buffer_;
+    elapsed_time_t last_time_ {0};
+    key_t last_key_ = 0;
+};
+
+inline void trace_writer_t::open(fs::path const& path) {
+    ofstream_ = std::ofstream(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!ofstream_)
+        throw exception_t(fmt::format("Failed to create trace file: {}", path.string()));
+    buffer_.clear();
+    buffer_.reserve(flush_threshold_k * 2);
+    buffer_.resize(trace_format_t::header_size_k);
+    std::memcpy(buffer_.data(), trace_format_t::magic_k.data(), trace_format_t::magic_k.size());
+    for (size_t byte = 0; byte != sizeof(trace_format_t::version_k); ++byte)
+        buffer_[trace_format_t::magic_k.size() + byte] = uint8_t(trace_format_t::version_k >> (byte * 8));
+    last_time_ = elapsed_time_t(0);
+    last_key_ = 0;
+}
+
+inline void trace_writer_t::close() {
+    if (!ofstream_.is_open())
+        return;
+    flush();
+    ofstream_.close();
+}
+
+inline void trace_writer_t::write(trace_record_t const& record) {
+    buffer_.push_back(uint8_t(record.operation));
+    write_varint(std::max(record.time - last_time_, elapsed_time_t(0)).count());
+    last_time_ = std::max(record.time, last_time_);
+
+    if (is_batch(record.operation))
+        write_varint(record.keys.size());
+    for (auto key : record.keys) {
+        write_varint(trace_format_t::zigzag(int64_t(key - last_key_)));
+        last_key_ = key;
+    }
+    if (is_write(record.operation))
+        for (auto length : record.value_lengths)
+            write_varint(length);
+    if (record.operation == operation_kind_t::range_select_k)
+        write_varint(record.length);
+
+    if (buffer_.size() >= flush_threshold_k)
+        flush();
+}
+
+/**
+ * @brief Decodes a trace in place from a read-only memory mapping.
+ */
+class trace_reader_t {
+  public:
+    inline trace_reader_t(fs::path const& path);
+    inline ~trace_reader_t() {
+        if (begin_)
+            munmap(const_cast<uint8_t*>(begin_), end_ - begin_);
+    }
+    trace_reader_t(trace_reader_t const&) = delete;
+    trace_reader_t& operator=(trace_reader_t const&) = delete;
+
+    /**
+     * @brief Decodes the next record.
+     * @return False, once the trace is over.
+     */
+    inline bool next(trace_record_t& record);
+
+  private:
+    inline uint64_t read_varint() {
+        uint64_t number = 0;
+        for (size_t shift = 0; shift < 7 * trace_format_t::varint_max_size_k; shift += 7) {
+            if (position_ == end_)
+                throw exception_t(fmt::format("Truncated trace file: {}", path_.string()));
+            uint8_t byte = *position_++;
+            number |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return number;
+        }
+        throw exception_t(fmt::format("Corrupted trace file: {}", path_.string()));
+    }
+
+    fs::path path_;
+    uint8_t const* begin_ = nullptr;
+    uint8_t const* end_ = nullptr;
+    uint8_t const* position_ = nullptr;
+
+    elapsed_time_t time_ {0};
+    key_t last_key_ = 0;
+    keys_t keys_;
+    value_lengths_t value_lengths_;
+};
+
+inline trace_reader_t::trace_reader_t(fs::path const& path) : path_(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw exception_t(fmt::format("Failed to open trace file: {}", path.string()));
+    struct stat file_stat;
+    size_t size = fstat(fd, &file_stat) == 0 ? size_t(file_stat.st_size) : 0;
+    if (size < trace_format_t::header_size_k) {
+        ::close(fd);
+        throw exception_t(fmt::format("Invalid trace file: {}", path.string()));
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        throw exception_t(fmt::format("Failed to map trace file: {}", path.string()));
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    begin_ = reinterpret_cast<uint8_t const*>(mapping);
+    end_ = begin_ + size;
+    uint64_t version = 0;
+    for (size_t byte = 0; byte != sizeof(version); ++byte)
+        version |= uint64_t(begin_[trace_format_t::magic_k.size() + byte]) << (byte * 8);
+    if (std::memcmp(begin_, trace_format_t::magic_k.data(), trace_format_t::magic_k.size()) != 0 ||
+        version != trace_format_t::version_k) {
+        munmap(mapping, size);
+        throw exception_t(fmt::format("Unsupported trace file: {}", path.string()));
+    }
+    position_ = begin_ + trace_format_t::header_size_k;
+}
+
+inline bool trace_reader_t::next(trace_record_t& record) {
+    if (position_ == end_)
+        return false;
+
+    auto operation = operation_kind_t(*position_++);
+    if (operation > operation_kind_t::scan_k)
+        throw exception_t(fmt::format("Corrupted trace file: {}", path_.string()));
+    time_ += elapsed_time_t(read_varint());
+
+    size_t keys_count = operation == operation_kind_t::scan_k ? 0 : 1;
+    if (is_batch(operation)) {
+        keys_count = read_varint();
+        // Note: Every key takes at least a byte, which bounds the count of corrupted traces
+        if (keys_count > size_t(end_ - position_))
+            throw exception_t(fmt::format("Corrupted trace file: {}", path_.string()));
+    }
+    // Note: Grows only up to the largest batch
+    if (keys_.size() < keys_count) {
+        keys_.resize(keys_count);
+        value_lengths_.resize(keys_count);
+    }
+    for (size_t idx = 0; idx != keys_count; ++idx) {
+        last_key_ += key_t(trace_format_t::unzigzag(read_varint()));
+        keys_[idx] = last_key_;
+    }
+    size_t value_lengths_count = is_write(operation) ? keys_count : 0;
+    for (size_t idx = 0; idx != value_lengths_count; ++idx)
+        value_lengths_[idx] = value_length_t(read_varint());
+
+    record.operation = operation;
+    record.time = time_;
+    record.keys = keys_spanc_t(keys_.data(), keys_count);
+    record.value_lengths = value_lengths_spanc_t(value_lengths_.data(), value_lengths_count);
+    record.length = operation == operation_kind_t::range_select_k ? read_varint() : 0;
+    return true;
+}
+
+/**
+ * @brief Interleaves traces by time into a single one, like the ones recorded by different threads.
+ */
+inline void merge_traces(std::vector<fs::path> const& paths, fs::path const& path) {
+    std::vector<std::unique_ptr<trace_reader_t>> readers;
+    std::vector<trace_record_t> records;
+    std::vector<bool> pending;
+    for (auto const& part_path : paths) {
+        readers.push_back(std::make_unique<trace_reader_t>(part_path));
+        records.emplace_back();
+        pending.push_back(readers.back()->next(records.back()));
+    }
+
+    trace_writer_t writer;
+    writer.open(path);
+    while (true) {
+        size_t earliest = readers.size();
+        for (size_t idx = 0; idx != readers.size(); ++idx)
+            if (pending[idx] && (earliest == readers.size() || records[idx].time < records[earliest].time))
+                earliest = idx;
+        if (earliest == readers.size())
+            break;
+        writer.write(records[earliest]);
+        pending[earliest] = readers[earliest]->next(records[earliest]);
+    }
+    writer.close();
+}
+
+/**
+ * @brief Forwards operations to the DB, recording each one into a trace as it's issued.
+ * Read-modify-writes are thus recorded as a read followed by an update.
+ * Note: Encoding happens within the measured time, so recording slightly inflates latencies.
+ */
+class trace_recorder_t : public data_accessor_t {
+  public:
+    inline trace_recorder_t(data_accessor_t& data_accessor, fs::path const& path)
+        : data_accessor_(&data_accessor), start_time_(high_resolution_clock_t::now()) {
+        writer_.open(path);
+    }
+
+    inline void close() { writer_.close(); }
+
+    operation_result_t upsert(key_t key, value_spanc_t value) override {
+        record(operation_kind_t::upsert_k, key, value.size());
+        return data_accessor_->upsert(key, value);
+    }
+    operation_result_t update(key_t key, value_spanc_t value) override {
+        record(operation_kind_t::update_k, key, value.size());
+        return data_accessor_->update(key, value);
+    }
+    operation_result_t remove(key_t key) override {
+        record(operation_kind_t::remove_k, key, 0);
+        return data_accessor_->remove(key);
+    }
+    operation_result_t read(key_t key, value_span_t value) const override {
+        record(operation_kind_t::read_k, key, 0);
+        return data_accessor_->read(key, value);
+    }
+    operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override {
+        record(operation_kind_t::batch_upsert_k, keys, sizes, 0);
+        return data_accessor_->batch_upsert(keys, values, sizes);
+    }
+    operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override {
+        record(operation_kind_t::batch_read_k, keys, {}, 0);
+        return data_accessor_->batch_read(keys, values);
+    }
+    operation_result_t bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override {
+        record(operation_kind_t::bulk_load_k, keys, sizes, 0);
+        return data_accessor_->bulk_load(keys, values, sizes);
+    }
+    operation_result_t range_select(key_t key, size_t length, values_span_t values) const override {
+        record(operation_kind_t::range_select_k, keys_spanc_t(&key, 1), {}, length);
+        return data_accessor_->range_select(key, length, values);
+    }
+    operation_result_t scan(key_t key, size_t length, value_span_t single_value) const override {
+        record(operation_kind_t::scan_k, {}, {}, 0);
+        return data_accessor_->scan(key, length, single_value);
+    }
+
+  private:
+    inline void record(operation_kind_t operation, key_t key, size_t value_length) const {
+        value_length_t length = value_length_t(value_length);
+        record(operation, keys_spanc_t(&key, 1), value_lengths_spanc_t(&length, 1), 0);
+    }
+    inline void record(operation_kind_t operation,
+                       keys_spanc_t keys,
+                       value_lengths_spanc_t value_lengths,
+                       size_t length) const {
+        trace_record_t record;
+        record.operation = operation;
+        record.time = std::chrono::duration_cast<elapsed_time_t>(high_resolution_clock_t::now() - start_time_);
+        record.keys = keys;
+        record.value_lengths = value_lengths;
+        record.length = length;
+        writer_.write(record);
+    }
+
+    data_accessor_t* data_accessor_;
+    time_point_t start_time_;
+    // Note: Reads are `const` in the accessor interface, but are recorded as well
+    mutable trace_writer_t writer_;
+};
+
+} // namespace ucsb
@@ -2,23 +2,33 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <utility>
-#include <set>
 #include <fmt/format.h>
 
 #include "src/core/types.hpp"
 #include "src/core/data_accessor.hpp"
+#include "src/core/async.hpp"
 #include "src/core/workload.hpp"
 #include "src/core/timer.hpp"
 #include "src/core/helper.hpp"
+#include "src/core/operation.hpp"
+#include "src/core/operations_stream.hpp"
+#include "src/core/keys_set.hpp"
+#include "src/core/trace.hpp"
 #include "src/core/generators/generator.hpp"
+#include "src/core/generators/rng.hpp"
 #include "src/core/generators/const_generator.hpp"
 #include "src/core/generators/counter_generator.hpp"
 #include "src/core/generators/uniform_generator.hpp"
 #include "src/core/generators/zipfian_generator.hpp"
 #include "src/core/generators/scrambled_zipfian_generator.hpp"
 #include "src/core/generators/skewed_zipfian_generator.hpp"
+#include "src/core/generators/hotspot_generator.hpp"
+#include "src/core/generators/exponential_generator.hpp"
+#include "src/core/generators/sequential_generator.hpp"
 #include "src/core/generators/acknowledged_counter_generator.hpp"
+#include "src/core/generators/payload_generator.hpp"
 
 namespace ucsb {
 
@@ -32,11 +42,23 @@ class worker_t {
     using key_generator_t = std::unique_ptr<core::generator_gt<key_t>>;
     using acknowledged_key_generator_t = std::unique_ptr<core::acknowledged_counter_generator_t>;
     using value_length_generator_t = std::unique_ptr<core::generator_gt<value_length_t>>;
-    using value_generator_t = core::random_byte_generator_t;
+    using value_generator_t = core::payload_generator_t;
     using length_generator_t = std::unique_ptr<core::generator_gt<size_t>>;
     using values_and_sizes_spanc_t = std::pair<values_spanc_t, value_lengths_spanc_t>;
+    using trace_reader_ptr_t = std::unique_ptr<trace_reader_t>;
 
-    worker_t(workload_t const& workload, data_accessor_t& data_accessor, timer_t& timer);
+    // Note: Replaying always goes through the stream, in chunks of this size by default
+    static constexpr size_t replay_chunk_k = 4096;
+
+    /**
+     * @param streams Random streams of the thread, shared with its other generators,
+     * every generator of the worker draws its own one.
+     */
+    worker_t(workload_t const& workload,
+             data_accessor_t& data_accessor,
+             timer_t& timer,
+             core::random_streams_t& streams,
+             huge_pages_t huge_pages = huge_pages_t::none_k);
 
     inline operation_result_t do_upsert();
     inline operation_result_t do_update();
@@ -49,7 +71,69 @@ class worker_t {
     inline operation_result_t do_range_select();
     inline operation_result_t do_scan();
 
+    /**
+     * @brief Draws the next `count` operations with all their keys and lengths in advance,
+     * switching the worker to replay them instead of drawing inline.
+     * Should be called outside of the measured time, whenever `pregenerated_left()` drops to zero.
+     * Note: Read keys are bound by the keys acknowledged at the moment of generation,
+     * so keys upserted within a chunk become visible to readers of the next one.
+     * When replaying a trace, operations are taken from it instead, and fewer than `count`
+     * are left only once the trace is over.
+     */
+    inline void pregenerate(operation_chooser_t& chooser, size_t count);
+    inline bool pregenerated() const noexcept { return pregenerated_; }
+    inline size_t pregenerated_left() const noexcept { return stream_.left(); }
+
+    inline bool replaying() const noexcept { return bool(trace_); }
+    /**
+     * @brief The time the next replayed operation was issued at, since the start of recording.
+     */
+    inline elapsed_time_t next_arrival() const noexcept { return stream_.peek_time(); }
+
+    /**
+     * @brief Chooses the next operation, or replays the pre-generated one.
+     */
+    inline operation_kind_t next_operation(operation_chooser_t& chooser) {
+        return pregenerated_ ? stream_.pop_operation() : chooser.choose();
+    }
+
+    /**
+     * @brief Switches to the key distribution and hot set of the next phase of the workload,
+     * dropping the operations pre-generated for the previous one.
+     */
+    inline void switch_phase(workload_t const& phase);
+
+    /**
+     * @brief The number of entries passed to the last batch operation or range select.
+     */
+    inline size_t last_batch_length() const noexcept { return last_batch_length_; }
+
+    /**
+     * @brief Allocates `depth` requests, each with its own keys and values,
+     * so that as many operations can be in flight at once.
+     */
+    inline void reserve_requests(size_t depth);
+    inline bool has_free_request() const noexcept { return !free_requests_.empty(); }
+    /**
+     * @brief Prepares the next operation in a free request, drawing or replaying its arguments.
+     */
+    inline async_request_t& prepare_request(operation_kind_t operation);
+    /**
+     * @brief Takes back the completed request, acknowledging the key it has upserted.
+     */
+    inline void release_request(async_request_t& request);
+
   private:
+    struct request_storage_t {
+        async_request_t request;
+        keys_t keys;
+        value_lengths_t value_lengths;
+        // Note: Fits a value more than the largest batch, to read and write at once in read-modify-writes
+        values_buffer_t values;
+    };
+
+    inline void reserve_request(request_storage_t& storage, size_t elements_count);
+
     inline key_generator_t create_key_generator(workload_t const& workload,
                                                 core::counter_generator_t& counter_generator);
     inline value_length_generator_t create_value_length_generator(workload_t const& workload);
@@ -57,24 +141,45 @@ class worker_t {
     inline length_generator_t create_batch_read_length_generator(workload_t const& workload);
     inline length_generator_t create_bulk_load_length_generator(workload_t const& workload);
     inline length_generator_t create_range_select_length_generator(workload_t const& workload);
+    static inline size_t hot_set_shift(workload_t const& workload) {
+        size_t shift = size_t(workload.hot_set_offset * workload.records_count);
+        return workload.records_count ? shift % workload.records_count : 0;
+    }
+
+    inline void replay(size_t count);
+    inline void reserve_batch(size_t length);
 
     inline key_t generate_key();
     inline keys_spanc_t generate_batch_upsert_keys();
     inline keys_spanc_t generate_batch_read_keys();
     inline keys_spanc_t generate_bulk_load_keys();
-    inline value_spanc_t generate_value();
-    inline values_and_sizes_spanc_t generate_values(size_t count);
+    inline keys_spanc_t generate_upsert_keys(size_t count);
+
+    // Either draw from generators, or replay the pre-generated stream
+    inline key_t next_key();
+    inline key_t next_upsert_key();
+    inline keys_spanc_t next_batch_upsert_keys();
+    inline keys_spanc_t next_batch_read_keys();
+    inline keys_spanc_t next_bulk_load_keys();
+    inline size_t next_range_select_length();
+    inline value_length_t next_value_length();
+    inline value_spanc_t generate_value(key_t key);
+    inline values_and_sizes_spanc_t generate_values(keys_spanc_t keys);
+    inline values_and_sizes_spanc_t generate_values(keys_spanc_t keys, std::byte* values, value_length_t* sizes);
     inline value_span_t value_buffer();
     inline values_span_t values_buffer(size_t count);
 
     workload_t workload_;
     data_accessor_t* data_accessor_;
     timer_t* timer_;
+    core::random_streams_t* streams_;
 
     key_generator_t upsert_key_sequence_generator;
     acknowledged_key_generator_t acknowledged_key_generator;
     key_generator_t key_generator_;
+    size_t hot_set_shift_ = 0;
     keys_t keys_buffer_;
+    keys_set_t unique_keys_;
 
     value_length_generator_t value_length_generator_;
     value_generator_t value_generator_;
@@ -85,13 +190,26 @@ class worker_t {
     length_generator_t batch_read_length_generator_;
     length_generator_t bulk_load_length_generator_;
     length_generator_t range_select_length_generator_;
+    size_t last_batch_length_ = 0;
+
+    bool pregenerated_ = false;
+    operations_stream_t stream_;
+    trace_reader_ptr_t trace_;
+
+    std::vector<request_storage_t> requests_;
+    std::vector<size_t> free_requests_;
 };
 
-worker_t::worker_t(workload_t const& workload, data_accessor_t& data_accessor, timer_t& timer)
-    : workload_(workload), data_accessor_(&data_accessor), timer_(&timer) {
+worker_t::worker_t(workload_t const& workload,
+                   data_accessor_t& data_accessor,
+                   timer_t& timer,
+                   core::random_streams_t& streams,
+                   huge_pages_t huge_pages)
+    : workload_(workload), data_accessor_(&data_accessor), timer_(&timer), streams_(&streams),
+      value_generator_(workload.value_length, workload.value_compression_ratio, streams.next()) {
 
-    if (workload.upsert_proportion == 1.0 || workload.batch_upsert_proportion == 1.0 ||
-        workload.bulk_load_proportion == 1.0)
+    // Note: Later phases may read, so they need the key generator
+    if (upserts_only(workload) && workload.phases.empty())
         upsert_key_sequence_generator = std::make_unique<core::counter_generator_t>(workload.start_key);
     else {
         acknowledged_key_generator =
@@ -99,27 +217,228 @@ worker_t::worker_t(workload_t const& workload, data_accessor_t& data_accessor, t
         key_generator_ = create_key_generator(workload, *acknowledged_key_generator);
         upsert_key_sequence_generator = std::move(acknowledged_key_generator);
     }
+    hot_set_shift_ = hot_set_shift(workload);
     size_t elements_max_count = std::max({workload.batch_upsert_max_length,
                                           workload.batch_read_max_length,
                                           workload.bulk_load_max_length,
                                           workload.range_select_max_length,
                                           size_t(1)});
     keys_buffer_ = keys_t(elements_max_count);
+    unique_keys_ = keys_set_t(workload.batch_read_max_length);
 
     value_length_generator_ = create_value_length_generator(workload);
     size_t value_aligned_length = roundup_to_multiple<values_buffer_t::alignment_k>(workload_.value_length);
-    values_buffer_ = values_buffer_t(elements_max_count * value_aligned_length);
+    values_buffer_ = values_buffer_t(elements_max_count * value_aligned_length, huge_pages);
     value_sizes_buffer_ = value_lengths_t(elements_max_count, 0);
 
     batch_upsert_length_generator_ = create_batch_upsert_length_generator(workload);
     batch_read_length_generator_ = create_batch_read_length_generator(workload);
     bulk_load_length_generator_ = create_bulk_load_length_generator(workload);
     range_select_length_generator_ = create_range_select_length_generator(workload);
+
+    if (workload.key_dist == distribution_kind_t::replay_k)
+        trace_ = std::make_unique<trace_reader_t>(workload.trace_path);
+}
+
+inline void worker_t::pregenerate(operation_chooser_t& chooser, size_t count) {
+    pregenerated_ = true;
+    stream_.clear();
+    stream_.reserve(count);
+    if (trace_) {
+        replay(count);
+        return;
+    }
+
+    for (size_t idx = 0; idx != count; ++idx) {
+        auto operation = chooser.choose();
+        stream_.push_operation(operation);
+
+        // Note: Must push exactly what the operation pops, in the same order
+        switch (operation) {
+        case operation_kind_t::upsert_k:
+            stream_.push_key(upsert_key_sequence_generator->generate());
+            stream_.push_value_length(value_length_generator_->generate());
+            break;
+        case operation_kind_t::update_k:
+        case operation_kind_t::read_modify_write_k:
+            stream_.push_key(generate_key());
+            stream_.push_value_length(value_length_generator_->generate());
+            break;
+        case operation_kind_t::remove_k:
+        case operation_kind_t::read_k: stream_.push_key(generate_key()); break;
+        case operation_kind_t::batch_upsert_k:
+        case operation_kind_t::bulk_load_k: {
+            auto& length_generator = operation == operation_kind_t::batch_upsert_k ? batch_upsert_length_generator_
+                                                                                   : bulk_load_length_generator_;
+            size_t length = length_generator->generate();
+            stream_.push_length(length);
+            for (size_t i = 0; i < length; ++i)
+                stream_.push_key(upsert_key_sequence_generator->generate());
+            for (size_t i = 0; i < length; ++i)
+                stream_.push_value_length(value_length_generator_->generate());
+            break;
+        }
+        case operation_kind_t::batch_read_k: {
+            keys_spanc_t keys = generate_batch_read_keys();
+            stream_.push_length(keys.size());
+            for (auto key : keys)
+                stream_.push_key(key);
+            break;
+        }
+        case operation_kind_t::range_select_k:
+            stream_.push_key(generate_key());
+            stream_.push_length(range_select_length_generator_->generate());
+            break;
+        case operation_kind_t::scan_k: break;
+        default: throw exception_t("Unknown operation");
+        }
+    }
+}
+
+inline void worker_t::replay(size_t count) {
+    trace_record_t record;
+    size_t replayed = 0;
+    while (replayed != count && trace_->next(record)) {
+        if (trace_partition(record, workload_.trace_partitions) != workload_.trace_partition)
+            continue;
+        stream_.push_operation(record.operation);
+        stream_.push_time(record.time);
+
+        // Note: Values are generated into buffers sized for the workload, so longer ones are cut
+        for (auto key : record.keys)
+            stream_.push_key(key);
+        for (auto length : record.value_lengths)
+            stream_.push_value_length(std::min(length, workload_.value_length));
+        if (is_batch(record.operation)) {
+            stream_.push_length(record.keys.size());
+            reserve_batch(record.keys.size());
+        }
+        if (record.operation == operation_kind_t::range_select_k) {
+            stream_.push_length(record.length);
+            reserve_batch(record.length);
+        }
+        ++replayed;
+    }
+}
+
+inline void worker_t::reserve_batch(size_t length) {
+    if (length <= value_sizes_buffer_.size())
+        return;
+    size_t value_aligned_length = roundup_to_multiple<values_buffer_t::alignment_k>(workload_.value_length);
+    values_buffer_ = values_buffer_t(length * value_aligned_length, values_buffer_.huge_pages());
+    value_sizes_buffer_ = value_lengths_t(length, 0);
+}
+
+inline void worker_t::reserve_requests(size_t depth) {
+    size_t elements_max_count = value_sizes_buffer_.size();
+    requests_ = std::vector<request_storage_t>(depth);
+    free_requests_.clear();
+    for (size_t idx = 0; idx != depth; ++idx) {
+        requests_[idx].request.tag = idx;
+        reserve_request(requests_[idx], elements_max_count);
+        free_requests_.push_back(idx);
+    }
+}
+
+inline void worker_t::reserve_request(request_storage_t& storage, size_t elements_count) {
+    if (elements_count <= storage.keys.size())
+        return;
+    size_t value_aligned_length = roundup_to_multiple<values_buffer_t::alignment_k>(workload_.value_length);
+    storage.keys = keys_t(elements_count);
+    storage.value_lengths = value_lengths_t(elements_count);
+    storage.values = values_buffer_t((elements_count + 1) * value_aligned_length, values_buffer_.huge_pages());
+}
+
+inline async_request_t& worker_t::prepare_request(operation_kind_t operation) {
+    auto& storage = requests_[free_requests_.back()];
+    free_requests_.pop_back();
+    auto& request = storage.request;
+    request.operation = operation;
+    request.length = 0;
+
+    // Note: Same as when executed synchronously, batches are prepared outside of the measured time
+    if (is_batch(operation))
+        timer_->pause();
+
+    key_t key = 0;
+    keys_spanc_t keys(&key, 1);
+    size_t values_count = 0;
+    switch (operation) {
+    case operation_kind_t::upsert_k:
+        key = next_upsert_key();
+        values_count = 1;
+        break;
+    case operation_kind_t::update_k:
+    case operation_kind_t::read_modify_write_k:
+        key = next_key();
+        values_count = 1;
+        break;
+    case operation_kind_t::remove_k:
+    case operation_kind_t::read_k: key = next_key(); break;
+    case operation_kind_t::batch_upsert_k:
+        keys = next_batch_upsert_keys();
+        values_count = keys.size();
+        break;
+    case operation_kind_t::batch_read_k: keys = next_batch_read_keys(); break;
+    case operation_kind_t::bulk_load_k:
+        keys = next_bulk_load_keys();
+        values_count = keys.size();
+        break;
+    case operation_kind_t::range_select_k:
+        key = next_key();
+        request.length = next_range_select_length();
+        break;
+    case operation_kind_t::scan_k:
+        key = workload_.start_key;
+        request.length = workload_.records_count;
+        break;
+    default: throw exception_t("Unknown operation");
+    }
+
+    size_t value_aligned_length = roundup_to_multiple<values_buffer_t::alignment_k>(workload_.value_length);
+    size_t read_count = operation == operation_kind_t::range_select_k ? request.length : keys.size();
+    reserve_request(storage, std::max(keys.size(), read_count));
+    std::copy(keys.begin(), keys.end(), storage.keys.begin());
+    request.keys = keys_spanc_t(storage.keys.data(), keys.size());
+
+    request.values = {};
+    request.value_lengths = {};
+    if (values_count) {
+        values_and_sizes_spanc_t values_and_sizes =
+            generate_values(keys.first(values_count), storage.values.data(), storage.value_lengths.data());
+        request.values = values_and_sizes.first;
+        request.value_lengths = values_and_sizes.second;
+    }
+
+    request.buffer = {};
+    if (is_read(operation)) {
+        size_t offset = operation == operation_kind_t::read_modify_write_k ? value_aligned_length : 0;
+        // Note: Scans read entries one by one into a single value
+        size_t buffer_count = operation == operation_kind_t::scan_k ? 1 : std::max<size_t>(read_count, 1);
+        request.buffer = values_span_t(storage.values.data() + offset, buffer_count * value_aligned_length);
+    }
+    if (is_batch(operation))
+        timer_->resume();
+    return request;
+}
+
+inline void worker_t::release_request(async_request_t& request) {
+    if (request.operation == operation_kind_t::upsert_k && acknowledged_key_generator)
+        acknowledged_key_generator->acknowledge(request.keys.front());
+    free_requests_.push_back(request.tag);
+}
+
+inline void worker_t::switch_phase(workload_t const& phase) {
+    assign_phase_mix(workload_, phase);
+    auto& counter_generator = static_cast<core::counter_generator_t&>(*upsert_key_sequence_generator);
+    key_generator_ = create_key_generator(workload_, counter_generator);
+    hot_set_shift_ = hot_set_shift(workload_);
+    stream_.clear();
 }
 
 inline operation_result_t worker_t::do_upsert() {
-    key_t key = upsert_key_sequence_generator->generate();
-    value_spanc_t value = generate_value();
+    key_t key = next_upsert_key();
+    value_spanc_t value = generate_value(key);
     auto status = data_accessor_->upsert(key, value);
     if (acknowledged_key_generator)
         acknowledged_key_generator->acknowledge(key);
@@ -127,36 +446,37 @@ inline operation_result_t worker_t::do_upsert() {
 }
 
 inline operation_result_t worker_t::do_update() {
-    key_t key = generate_key();
-    value_spanc_t value = generate_value();
+    key_t key = next_key();
+    value_spanc_t value = generate_value(key);
     return data_accessor_->update(key, value);
 }
 
 inline operation_result_t worker_t::do_remove() {
-    key_t key = generate_key();
+    key_t key = next_key();
     return data_accessor_->remove(key);
 }
 
 inline operation_result_t worker_t::do_read() {
-    key_t key = generate_key();
+    key_t key = next_key();
     value_span_t value = value_buffer();
     return data_accessor_->read(key, value);
 }
 
 inline operation_result_t worker_t::do_read_modify_write() {
-    key_t key = generate_key();
+    key_t key = next_key();
     value_span_t read_value = value_buffer();
     data_accessor_->read(key, read_value);
 
-    value_spanc_t value = generate_value();
+    value_spanc_t value = generate_value(key);
     return data_accessor_->update(key, value);
 }
 
 inline operation_result_t worker_t::do_batch_upsert() {
     // Note: Pause benchmark timer to do data preparation, to measure batch upsert time only
     timer_->pause();
-    keys_spanc_t keys = generate_batch_upsert_keys();
-    values_and_sizes_spanc_t values_and_sizes = generate_values(keys.size());
+    keys_spanc_t keys = next_batch_upsert_keys();
+    values_and_sizes_spanc_t values_and_sizes = generate_values(keys);
+    last_batch_length_ = keys.size();
     timer_->resume();
 
     return data_accessor_->batch_upsert(keys, values_and_sizes.first, values_and_sizes.second);
@@ -165,8 +485,9 @@ inline operation_result_t worker_t::do_batch_upsert() {
 inline operation_result_t worker_t::do_batch_read() {
     // Note: Pause benchmark timer to do data preparation, to measure batch read time only
     timer_->pause();
-    keys_spanc_t keys = generate_batch_read_keys();
+    keys_spanc_t keys = next_batch_read_keys();
     values_span_t values = values_buffer(keys.size());
+    last_batch_length_ = keys.size();
     timer_->resume();
     return data_accessor_->batch_read(keys, values);
 }
@@ -174,17 +495,19 @@ inline operation_result_t worker_t::do_batch_read() {
 inline operation_result_t worker_t::do_bulk_load() {
     // Note: Pause benchmark timer to do data preparation, to measure bulk load time only
     timer_->pause();
-    keys_spanc_t keys = generate_bulk_load_keys();
-    values_and_sizes_spanc_t values_and_sizes = generate_values(keys.size());
+    keys_spanc_t keys = next_bulk_load_keys();
+    values_and_sizes_spanc_t values_and_sizes = generate_values(keys);
+    last_batch_length_ = keys.size();
     timer_->resume();
 
     return data_accessor_->bulk_load(keys, values_and_sizes.first, values_and_sizes.second);
 }
 
 inline operation_result_t worker_t::do_range_select() {
-    key_t key = generate_key();
-    size_t length = range_select_length_generator_->generate();
+    key_t key = next_key();
+    size_t length = next_range_select_length();
     values_span_t values = values_buffer(length);
+    last_batch_length_ = length;
     return data_accessor_->range_select(key, length, values);
 }
 
@@ -200,18 +523,46 @@ inline worker_t::key_generator_t worker_t::create_key_generator(workload_t const
     case distribution_kind_t::uniform_k:
         generator =
             std::make_unique<core::uniform_generator_gt<key_t>>(workload.start_key,
-                                                                workload.start_key + workload.records_count - 1);
+                                                                workload.start_key + workload.records_count - 1,
+                                                                streams_->next());
         break;
     case distribution_kind_t::zipfian_k: {
-        size_t new_keys = (size_t)(workload.operations_count * workload.upsert_proportion * 2);
+        size_t operations_count = workload.warmup_operations + workload.operations_count;
+        size_t new_keys = (size_t)(operations_count * workload.upsert_proportion * 2);
         generator = std::make_unique<core::scrambled_zipfian_generator_t>(workload.start_key,
                                                                           workload.start_key + workload.records_count +
-                                                                              new_keys - 1);
+                                                                              new_keys - 1,
+                                                                          streams_->next(),
+                                                                          workload.zipfian_theta);
         break;
     }
     case distribution_kind_t::skewed_latest_k:
-        generator = std::make_unique<core::skewed_latest_generator_t>(counter_generator);
+        generator = std::make_unique<core::skewed_latest_generator_t>(counter_generator,
+                                                                      streams_->next(),
+                                                                      workload.zipfian_theta);
+        break;
+    case distribution_kind_t::hotspot_k:
+        generator = std::make_unique<core::hotspot_generator_t>(workload.start_key,
+                                                                workload.start_key + workload.records_count - 1,
+                                                                workload.hotspot_keys_fraction,
+                                                                workload.hotspot_operations_fraction,
+                                                                streams_->next());
         break;
+    case distribution_kind_t::exponential_k:
+        generator = std::make_unique<core::exponential_generator_t>(counter_generator,
+                                                                    workload.start_key,
+                                                                    workload.exponential_percentile,
+                                                                    workload.records_count *
+                                                                        workload.exponential_fraction,
+                                                                    streams_->next());
+        break;
+    case distribution_kind_t::sequential_k:
+        generator = std::make_unique<core::sequential_generator_t>(workload.start_key,
+                                                                   workload.start_key + workload.records_count - 1,
+                                                                   workload.sequential_stride);
+        break;
+    // Note: Keys come from the trace
+    case distribution_kind_t::replay_k: break;
     default: throw exception_t(fmt::format("Unknown key distribution: {}", int(workload.key_dist)));
     }
     return generator;
@@ -225,7 +576,8 @@ inline worker_t::value_length_generator_t worker_t::create_value_length_generato
         generator = std::make_unique<core::const_generator_gt<value_length_t>>(workload.value_length);
         break;
     case distribution_kind_t::uniform_k:
-        generator = std::make_unique<core::uniform_generator_gt<value_length_t>>(1, workload.value_length);
+        generator =
+            std::make_unique<core::uniform_generator_gt<value_length_t>>(1, workload.value_length, streams_->next());
         break;
     default: throw exception_t(fmt::format("Unknown value length distribution: {}", int(workload.value_length_dist)));
     }
@@ -238,11 +590,13 @@ inline worker_t::length_generator_t worker_t::create_batch_upsert_length_generat
     switch (workload.batch_upsert_length_dist) {
     case distribution_kind_t::uniform_k:
         generator = std::make_unique<core::uniform_generator_gt<size_t>>(workload.batch_upsert_min_length,
-                                                                         workload.batch_upsert_max_length);
+                                                                         workload.batch_upsert_max_length,
+                                                                         streams_->next());
         break;
     case distribution_kind_t::zipfian_k:
         generator = std::make_unique<core::zipfian_generator_t>(workload.batch_upsert_min_length,
-                                                                workload.batch_upsert_max_length);
+                                                                workload.batch_upsert_max_length,
+                                                                streams_->next());
         break;
     default:
         throw exception_t(
@@ -256,11 +610,13 @@ inline worker_t::length_generator_t worker_t::create_batch_read_length_generator
     switch (workload.batch_read_length_dist) {
     case distribution_kind_t::uniform_k:
         generator = std::make_unique<core::uniform_generator_gt<size_t>>(workload.batch_read_min_length,
-                                                                         workload.batch_read_max_length);
+                                                                         workload.batch_read_max_length,
+                                                                         streams_->next());
         break;
     case distribution_kind_t::zipfian_k:
-        generator =
-            std::make_unique<core::zipfian_generator_t>(workload.batch_read_min_length, workload.batch_read_max_length);
+        generator = std::make_unique<core::zipfian_generator_t>(workload.batch_read_min_length,
+                                                                workload.batch_read_max_length,
+                                                                streams_->next());
         break;
     default:
         throw exception_t(
@@ -275,11 +631,13 @@ inline worker_t::length_generator_t worker_t::create_bulk_load_length_generator(
     switch (workload.bulk_load_length_dist) {
     case distribution_kind_t::uniform_k:
         generator = std::make_unique<core::uniform_generator_gt<size_t>>(workload.bulk_load_min_length,
-                                                                         workload.bulk_load_max_length);
+                                                                         workload.bulk_load_max_length,
+                                                                         streams_->next());
         break;
     case distribution_kind_t::zipfian_k:
-        generator =
-            std::make_unique<core::zipfian_generator_t>(workload.bulk_load_min_length, workload.bulk_load_max_length);
+        generator = std::make_unique<core::zipfian_generator_t>(workload.bulk_load_min_length,
+                                                                workload.bulk_load_max_length,
+                                                                streams_->next());
         break;
     default:
         throw exception_t(
@@ -294,11 +652,13 @@ inline worker_t::length_generator_t worker_t::create_range_select_length_generat
     switch (workload.range_select_length_dist) {
     case distribution_kind_t::uniform_k:
         generator = std::make_unique<core::uniform_generator_gt<size_t>>(workload.range_select_min_length,
-                                                                         workload.range_select_max_length);
+                                                                         workload.range_select_max_length,
+                                                                         streams_->next());
         break;
     case distribution_kind_t::zipfian_k:
         generator = std::make_unique<core::zipfian_generator_t>(workload.range_select_min_length,
-                                                                workload.range_select_max_length);
+                                                                workload.range_select_max_length,
+                                                                streams_->next());
         break;
     default:
         throw exception_t(
@@ -312,68 +672,107 @@ inline key_t worker_t::generate_key() {
     do {
         key = key_generator_->generate();
     } while (key > upsert_key_sequence_generator->last());
+    // Note: Shifts the hot set, wrapping around the records of the thread
+    if (hot_set_shift_ && key - workload_.start_key < workload_.records_count)
+        key = workload_.start_key + (key - workload_.start_key + hot_set_shift_) % workload_.records_count;
     return key;
 }
 
 inline keys_spanc_t worker_t::generate_batch_upsert_keys() {
-    size_t batch_length = batch_upsert_length_generator_->generate();
-    keys_span_t keys(keys_buffer_.data(), batch_length);
-    for (size_t i = 0; i < batch_length; ++i) {
-        key_t key = upsert_key_sequence_generator->generate();
-        keys[i] = key;
-        if (acknowledged_key_generator)
-            acknowledged_key_generator->acknowledge(key);
-    }
-
-    return keys;
+    return generate_upsert_keys(batch_upsert_length_generator_->generate());
 }
 
 inline keys_spanc_t worker_t::generate_batch_read_keys() {
     size_t batch_length = batch_read_length_generator_->generate();
     keys_span_t keys(keys_buffer_.data(), batch_length);
     size_t unique_keys_count = 0;
-    std::set<key_t> unique_keys;
+    unique_keys_.clear();
     while (unique_keys_count != batch_length) {
         auto key = generate_key();
-        if (!unique_keys.contains(key)) {
+        if (unique_keys_.insert(key)) {
             keys[unique_keys_count] = key;
             unique_keys_count++;
-            unique_keys.insert(key);
         }
     }
     return keys;
 }
 
 inline keys_spanc_t worker_t::generate_bulk_load_keys() {
-    size_t bulk_length = bulk_load_length_generator_->generate();
-    keys_span_t keys(keys_buffer_.data(), bulk_length);
-    for (size_t i = 0; i < bulk_length; ++i) {
-        key_t key = upsert_key_sequence_generator->generate();
-        keys[i] = key;
-        if (acknowledged_key_generator)
+    return generate_upsert_keys(bulk_load_length_generator_->generate());
+}
+
+inline keys_spanc_t worker_t::generate_upsert_keys(size_t count) {
+    keys_span_t keys(keys_buffer_.data(), count);
+    upsert_key_sequence_generator->fill(keys);
+    if (acknowledged_key_generator)
+        for (auto key : keys)
             acknowledged_key_generator->acknowledge(key);
-    }
 
     return keys;
 }
 
-inline value_spanc_t worker_t::generate_value() {
-    values_and_sizes_spanc_t value_and_size = generate_values(1);
+inline key_t worker_t::next_key() { return pregenerated_ ? stream_.pop_key() : generate_key(); }
+
+inline key_t worker_t::next_upsert_key() {
+    return pregenerated_ ? stream_.pop_key() : upsert_key_sequence_generator->generate();
+}
+
+inline keys_spanc_t worker_t::next_batch_upsert_keys() {
+    if (!pregenerated_)
+        return generate_batch_upsert_keys();
+
+    // Note: Keys are acknowledged when they are actually upserted, same as when drawn inline
+    keys_spanc_t keys = stream_.pop_keys(stream_.pop_length());
+    if (acknowledged_key_generator)
+        for (auto key : keys)
+            acknowledged_key_generator->acknowledge(key);
+    return keys;
+}
+
+inline keys_spanc_t worker_t::next_batch_read_keys() {
+    return pregenerated_ ? stream_.pop_keys(stream_.pop_length()) : generate_batch_read_keys();
+}
+
+inline keys_spanc_t worker_t::next_bulk_load_keys() {
+    if (!pregenerated_)
+        return generate_bulk_load_keys();
+
+    keys_spanc_t keys = stream_.pop_keys(stream_.pop_length());
+    if (acknowledged_key_generator)
+        for (auto key : keys)
+            acknowledged_key_generator->acknowledge(key);
+    return keys;
+}
+
+inline size_t worker_t::next_range_select_length() {
+    return pregenerated_ ? stream_.pop_length() : range_select_length_generator_->generate();
+}
+
+inline value_length_t worker_t::next_value_length() {
+    return pregenerated_ ? stream_.pop_value_length() : value_length_generator_->generate();
+}
+
+inline value_spanc_t worker_t::generate_value(key_t key) {
+    values_and_sizes_spanc_t value_and_size = generate_values(keys_spanc_t(&key, 1));
     return value_spanc_t {value_and_size.first.data(), value_and_size.second.front()};
 }
 
-inline worker_t::values_and_sizes_spanc_t worker_t::generate_values(size_t count) {
-    for (size_t i = 0; i < count * workload_.value_length; ++i)
-        values_buffer_[i] = std::byte(value_generator_.generate());
+inline worker_t::values_and_sizes_spanc_t worker_t::generate_values(keys_spanc_t keys) {
+    return generate_values(keys, values_buffer_.data(), value_sizes_buffer_.data());
+}
 
+inline worker_t::values_and_sizes_spanc_t worker_t::generate_values(keys_spanc_t keys,
+                                                                    std::byte* values,
+                                                                    value_length_t* sizes) {
+    // Note: Values are packed one after another, so only the bytes they actually have are generated
     size_t total_length = 0;
-    for (size_t i = 0; i < count; ++i) {
-        value_length_t length = value_length_generator_->generate();
-        value_sizes_buffer_[i] = length;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        value_length_t length = next_value_length();
+        sizes[i] = length;
+        value_generator_.fill(keys[i], std::span<std::byte>(values + total_length, length));
         total_length += length;
     }
-    return std::make_pair(values_spanc_t(values_buffer_.data(), total_length),
-                          value_lengths_spanc_t(value_sizes_buffer_.data(), count));
+    return std::make_pair(values_spanc_t(values, total_length), value_lengths_spanc_t(sizes, keys.size()));
 }
 
 inline value_span_t worker_t::value_buffer() { return values_buffer(1); }
@@ -4,11 +4,13 @@
 #include <string>
 #include <cstddef>
 #include <fstream>
+#include <algorithm>
 
 #include <nlohmann/json.hpp>
 
 #include "src/core/types.hpp"
 #include "src/core/distribution.hpp"
+#include "src/core/slo.hpp"
 
 using json = nlohmann::json;
 
@@ -44,6 +46,28 @@ struct workload_t {
      * which will be done by a single thread, divided by the number of threads.
      */
     size_t operations_count = 0;
+    /**
+     * @brief Operations arrival rate across all threads for open-loop benchmarks.
+     * Every operation is scheduled at an intended start time and its latency is
+     * measured from it, so queueing delays are included. Zero means closed-loop.
+     */
+    double target_ops_per_second = 0;
+    /**
+     * @brief Wall-clock limit of the measured phase in seconds, zero means unlimited.
+     * All threads stop once it elapses, so `operations_count` becomes just an upper bound.
+     */
+    double duration_s = 0;
+    /**
+     * @brief Warm-up phase before the measured one, which lasts until both its
+     * duration elapses and its operations are done. Warm-up operations are
+     * executed, but excluded from all counters and histograms.
+     */
+    double warmup_s = 0;
+    size_t db_warmup_operations = 0;
+    /**
+     * @brief Number of warm-up operations of a single thread, divided by the number of threads.
+     */
+    size_t warmup_operations = 0;
 
     float upsert_proportion = 0;
     float update_proportion = 0;
@@ -58,9 +82,51 @@ struct workload_t {
 
     key_t start_key = 0;
     distribution_kind_t key_dist = distribution_kind_t::uniform_k;
+    /**
+     * @brief Skew of the "zipfian" and "latest" key distributions, the exponent of the rank.
+     * Larger ones concentrate accesses on fewer keys, the YCSB default is 0.99.
+     */
+    double zipfian_theta = 0.99;
+    /**
+     * @brief The "hotspot" key distribution accesses the first `hotspot_keys_fraction` of the records
+     * with `hotspot_operations_fraction` of operations, uniformly within both sets.
+     */
+    double hotspot_keys_fraction = 0.2;
+    double hotspot_operations_fraction = 0.8;
+    /**
+     * @brief The "exponential" key distribution accesses the latest `exponential_fraction` of the records
+     * with `exponential_percentile` percent of operations, the older keys the less, the YCSB defaults.
+     */
+    double exponential_percentile = 95;
+    double exponential_fraction = 0.8571428571;
+    /**
+     * @brief The "sequential" key distribution walks the records in steps of this many keys, wrapping around.
+     */
+    size_t sequential_stride = 1;
+    /**
+     * @brief Moves the hot keys of the distribution by this fraction of the records
+     * of the thread, wrapping around, to emulate a shifting hot set.
+     */
+    double hot_set_offset = 0;
+
+    /**
+     * @brief The trace to replay operations from, with the "replay" key distribution.
+     * Then the trace defines operations, keys and lengths, instead of proportions and generators.
+     * Every thread replays the records of its own partition of keys, either as fast
+     * as possible, or at the times they were recorded, relative to the first one.
+     */
+    std::string trace_path;
+    bool replay_original_timing = false;
+    size_t trace_partition = 0;
+    size_t trace_partitions = 1;
 
     value_length_t value_length = 0;
     distribution_kind_t value_length_dist = distribution_kind_t::const_k;
+    /**
+     * @brief Target compressed to raw size ratio of values, from 0 exclusive to 1 for incompressible ones,
+     * the same as "compression_ratio" in "db_bench".
+     */
+    double value_compression_ratio = 1.0;
 
     size_t batch_upsert_min_length = 0;
     size_t batch_upsert_max_length = 0;
@@ -77,6 +143,36 @@ struct workload_t {
     size_t range_select_min_length = 0;
     size_t range_select_max_length = 0;
     distribution_kind_t range_select_length_dist = distribution_kind_t::uniform_k;
+
+    /**
+     * @brief Consecutive phases of the measured part of the workload, each lasting `duration_s`.
+     * A phase has its own mix of operations, key distribution and hot set offset,
+     * the rest is shared with the workload. The workload itself starts with the
+     * mix of the first phase and lasts for the sum of their durations.
+     */
+    std::vector<workload_t> phases;
+
+    /**
+     * @brief Groups of threads running concurrently, each with its own number of threads,
+     * mix of operations, key distribution and rate limit, the rest is shared with the workload.
+     * Then the workload runs with as many threads as its groups have together.
+     * Every group splits the records of the workload among its threads, unless it only
+     * upserts, in which case its threads upsert new keys after the records.
+     */
+    std::vector<workload_t> groups;
+    /**
+     * @brief Number of threads in a group. Once split, the number of threads sharing the workload,
+     * which are the threads of its group in grouped workloads.
+     */
+    size_t threads_count = 0;
+    size_t group_idx = 0;
+
+    /**
+     * @brief Searches for the saturation point under a latency objective, instead of running at a fixed rate.
+     * The measured part is split into equal phases, called steps, each at a rate picked from the
+     * latencies of the previous ones, while the DB stays open.
+     */
+    slo_t slo;
 };
 
 using workloads_t = std::vector<workload_t>;
@@ -97,9 +193,225 @@ inline distribution_kind_t parse_distribution(std::string const& name) {
         dist = distribution_kind_t::skewed_latest_k;
     else if (name == "acknowledged")
         dist = distribution_kind_t::acknowledged_counter_k;
+    else if (name == "replay")
+        dist = distribution_kind_t::replay_k;
+    else if (name == "hotspot")
+        dist = distribution_kind_t::hotspot_k;
+    else if (name == "exponential")
+        dist = distribution_kind_t::exponential_k;
+    else if (name == "sequential")
+        dist = distribution_kind_t::sequential_k;
     return dist;
 }
 
+/**
+ * @brief Whether the workload only adds new keys, so it needs no keys to be present.
+ */
+inline bool upserts_only(workload_t const& workload) noexcept {
+    return workload.upsert_proportion == 1.0 || workload.batch_upsert_proportion == 1.0 ||
+           workload.bulk_load_proportion == 1.0;
+}
+
+/**
+ * @brief The most new keys, that a thread of an upserts-only workload adds in `operations_count` operations.
+ */
+inline size_t new_records_count(workload_t const& workload, size_t operations_count) noexcept {
+    return bool(workload.upsert_proportion) * operations_count +
+           bool(workload.bulk_load_proportion) * operations_count * workload.bulk_load_max_length +
+           bool(workload.batch_upsert_proportion) * operations_count * workload.batch_upsert_max_length;
+}
+
+/**
+ * @brief Whether any thread of the benchmark warms up. Then all of them must wait for each other after it,
+ * even those left without warm-up operations, so it's decided by what all the threads share.
+ */
+inline bool warms_up(workload_t const& workload) noexcept {
+    bool warms_up = workload.warmup_s > 0 || workload.db_warmup_operations;
+    // Note: Threads of grouped workloads know all groups, which may warm up differently
+    for (auto const& group : workload.groups)
+        warms_up |= group.warmup_s > 0 || group.db_warmup_operations;
+    return warms_up;
+}
+
+/**
+ * @brief Copies the parts of a workload, that its phases may change.
+ */
+inline void assign_phase_mix(workload_t& workload, workload_t const& phase) {
+    workload.upsert_proportion = phase.upsert_proportion;
+    workload.update_proportion = phase.update_proportion;
+    workload.remove_proportion = phase.remove_proportion;
+    workload.read_proportion = phase.read_proportion;
+    workload.read_modify_write_proportion = phase.read_modify_write_proportion;
+    workload.batch_upsert_proportion = phase.batch_upsert_proportion;
+    workload.batch_read_proportion = phase.batch_read_proportion;
+    workload.bulk_load_proportion = phase.bulk_load_proportion;
+    workload.range_select_proportion = phase.range_select_proportion;
+    workload.scan_proportion = phase.scan_proportion;
+    workload.key_dist = phase.key_dist;
+    workload.zipfian_theta = phase.zipfian_theta;
+    workload.hotspot_keys_fraction = phase.hotspot_keys_fraction;
+    workload.hotspot_operations_fraction = phase.hotspot_operations_fraction;
+    workload.exponential_percentile = phase.exponential_percentile;
+    workload.exponential_fraction = phase.exponential_fraction;
+    workload.sequential_stride = phase.sequential_stride;
+    workload.hot_set_offset = phase.hot_set_offset;
+}
+
+inline void load_proportions(json const& j_workload, workload_t& workload) {
+    workload.upsert_proportion = j_workload.value("upsert_proportion", 0.0);
+    workload.update_proportion = j_workload.value("update_proportion", 0.0);
+    workload.remove_proportion = j_workload.value("remove_proportion", 0.0);
+    workload.read_proportion = j_workload.value("read_proportion", 0.0);
+    workload.read_modify_write_proportion = j_workload.value("read_modify_write_proportion", 0.0);
+    workload.batch_upsert_proportion = j_workload.value("batch_upsert_proportion", 0.0);
+    workload.batch_read_proportion = j_workload.value("batch_read_proportion", 0.0);
+    workload.bulk_load_proportion = j_workload.value("bulk_load_proportion", 0.0);
+    workload.range_select_proportion = j_workload.value("range_select_proportion", 0.0);
+    workload.scan_proportion = j_workload.value("scan_proportion", 0.0);
+}
+
+/**
+ * @brief Loads parameters of key distributions, keeping the current ones by default.
+ */
+inline void load_key_dist_parameters(json const& j_workload, workload_t& workload) {
+    workload.zipfian_theta = j_workload.value("zipfian_theta", workload.zipfian_theta);
+    workload.hotspot_keys_fraction = j_workload.value("hotspot_keys_fraction", workload.hotspot_keys_fraction);
+    workload.hotspot_operations_fraction =
+        j_workload.value("hotspot_operations_fraction", workload.hotspot_operations_fraction);
+    workload.exponential_percentile = j_workload.value("exponential_percentile", workload.exponential_percentile);
+    workload.exponential_fraction = j_workload.value("exponential_fraction", workload.exponential_fraction);
+    workload.sequential_stride = j_workload.value("sequential_stride", workload.sequential_stride);
+}
+
+/**
+ * @brief Loads lengths of batches and range selects, keeping the current ones by default.
+ */
+inline void load_lengths(json const& j_workload, workload_t& workload) {
+    workload.batch_upsert_min_length = j_workload.value("batch_upsert_min_length", workload.batch_upsert_min_length);
+    workload.batch_upsert_max_length = j_workload.value("batch_upsert_max_length", workload.batch_upsert_max_length);
+    workload.batch_read_min_length = j_workload.value("batch_read_min_length", workload.batch_read_min_length);
+    workload.batch_read_max_length = j_workload.value("batch_read_max_length", workload.batch_read_max_length);
+    workload.bulk_load_min_length = j_workload.value("bulk_load_min_length", workload.bulk_load_min_length);
+    workload.bulk_load_max_length = j_workload.value("bulk_load_max_length", workload.bulk_load_max_length);
+    workload.range_select_min_length = j_workload.value("range_select_min_length", workload.range_select_min_length);
+    workload.range_select_max_length = j_workload.value("range_select_max_length", workload.range_select_max_length);
+}
+
+/**
+ * @brief Loads phases of the workload, each inheriting whatever it doesn't override.
+ * Note: Proportions are inherited all at once, only if the phase specifies none of them.
+ */
+inline bool load_phases(json const& j_phases, workload_t& workload) {
+    for (auto j_phase = j_phases.begin(); j_phase != j_phases.end(); ++j_phase) {
+        workload_t phase = workload;
+        phase.phases.clear();
+        phase.name = (*j_phase).value("name", "phase" + std::to_string(workload.phases.size() + 1));
+        phase.duration_s = (*j_phase).value("duration_s", 0.0);
+        phase.hot_set_offset = (*j_phase).value("hot_set_offset", workload.hot_set_offset);
+        load_key_dist_parameters(*j_phase, phase);
+        bool has_proportions = false;
+        for (auto it = j_phase->begin(); it != j_phase->end(); ++it)
+            has_proportions |= it.key().ends_with("_proportion");
+        if (has_proportions)
+            load_proportions(*j_phase, phase);
+        if ((*j_phase).contains("key_dist"))
+            phase.key_dist = parse_distribution((*j_phase)["key_dist"].get<std::string>());
+        if (phase.key_dist == distribution_kind_t::unknown_k)
+            return false;
+        workload.phases.push_back(phase);
+    }
+    if (workload.phases.empty())
+        return true;
+
+    workload.duration_s = 0;
+    for (auto const& phase : workload.phases)
+        workload.duration_s += phase.duration_s;
+    assign_phase_mix(workload, workload.phases.front());
+    return true;
+}
+
+/**
+ * @brief Loads the latency objective of a saturation search, and splits the workload into its steps.
+ */
+inline bool load_slo(json const& j_slo, workload_t& workload) {
+    slo_t& slo = workload.slo;
+    slo.percentile = j_slo.value("percentile", slo.percentile);
+    slo.latency_ms = j_slo.value("latency_ms", 0.0);
+    slo.start_ops_per_second = j_slo.value("start_ops_per_second", 0.0);
+    slo.max_ops_per_second = j_slo.value("max_ops_per_second", 0.0);
+    slo.steps = j_slo.value("steps", 10);
+    slo.step_s = j_slo.value("step_s", 1.0);
+    if (!slo.enabled() || slo.percentile <= 0 || slo.percentile > 100 || slo.start_ops_per_second <= 0 ||
+        slo.max_ops_per_second < slo.start_ops_per_second || !slo.steps || slo.step_s <= 0)
+        return false;
+
+    for (size_t idx = 0; idx != slo.steps; ++idx) {
+        workload_t step = workload;
+        step.phases.clear();
+        step.name = "step" + std::to_string(idx + 1);
+        step.duration_s = slo.step_s;
+        workload.phases.push_back(step);
+    }
+    workload.duration_s = slo.steps * slo.step_s;
+    workload.target_ops_per_second = slo.start_ops_per_second;
+    return true;
+}
+
+/**
+ * @brief Loads thread groups of the workload, each inheriting whatever it doesn't override.
+ * Note: Operations are split between groups by their threads, unless a group sets its own count.
+ */
+inline bool load_groups(json const& j_groups, workload_t& workload) {
+    size_t threads_count = 0;
+    for (auto j_group = j_groups.begin(); j_group != j_groups.end(); ++j_group)
+        threads_count += (*j_group).value("threads", 0);
+    if (!threads_count)
+        return false;
+
+    // Note: Upserts-only groups add disjoint ranges of new keys, one after another
+    key_t new_keys_start = workload.start_key + workload.db_records_count;
+    for (auto j_group = j_groups.begin(); j_group != j_groups.end(); ++j_group) {
+        workload_t group = workload;
+        group.groups.clear();
+        group.name = (*j_group).value("name", "group" + std::to_string(workload.groups.size() + 1));
+        group.threads_count = (*j_group).value("threads", 0);
+        if (!group.threads_count)
+            return false;
+        size_t operations_count = workload.db_operations_count * group.threads_count / threads_count;
+        group.db_operations_count = (*j_group).value("operations_count", operations_count);
+        size_t warmup_operations = workload.db_warmup_operations * group.threads_count / threads_count;
+        group.db_warmup_operations = (*j_group).value("warmup_operations", warmup_operations);
+        double target_ops_per_second = workload.target_ops_per_second * group.threads_count / threads_count;
+        group.target_ops_per_second = (*j_group).value("target_ops_per_second", target_ops_per_second);
+        group.hot_set_offset = (*j_group).value("hot_set_offset", workload.hot_set_offset);
+        load_key_dist_parameters(*j_group, group);
+        bool has_proportions = false;
+        for (auto it = j_group->begin(); it != j_group->end(); ++it)
+            has_proportions |= it.key().ends_with("_proportion");
+        if (has_proportions)
+            load_proportions(*j_group, group);
+        load_lengths(*j_group, group);
+        bool adds_new_keys = upserts_only(group) && !(*j_group).contains("start_key");
+        group.start_key = (*j_group).value("start_key", adds_new_keys ? new_keys_start : workload.start_key);
+        // Note: Counts new keys the same way, as the group is later split among its threads
+        for (size_t idx = 0; adds_new_keys && idx != group.threads_count; ++idx) {
+            size_t operations_count = group.db_operations_count / group.threads_count +
+                                      (idx < group.db_operations_count % group.threads_count);
+            size_t warmup_operations = group.db_warmup_operations / group.threads_count +
+                                       (idx < group.db_warmup_operations % group.threads_count);
+            new_keys_start += new_records_count(group, std::max(size_t(1), operations_count) + warmup_operations);
+        }
+        if ((*j_group).contains("key_dist"))
+            group.key_dist = parse_distribution((*j_group)["key_dist"].get<std::string>());
+        if (group.key_dist == distribution_kind_t::unknown_k)
+            return false;
+        group.group_idx = workload.groups.size();
+        workload.groups.push_back(group);
+    }
+    workload.threads_count = threads_count;
+    return true;
+}
+
 bool load(fs::path const& path, workloads_t& workloads) {
 
     workloads.clear();
@@ -117,17 +429,12 @@ bool load(fs::path const& path, workloads_t& workloads) {
 
         workload.db_records_count = (*j_workload)["records_count"].get<size_t>();
         workload.db_operations_count = (*j_workload)["operations_count"].get<size_t>();
+        workload.target_ops_per_second = (*j_workload).value("target_ops_per_second", 0.0);
+        workload.duration_s = (*j_workload).value("duration_s", 0.0);
+        workload.warmup_s = (*j_workload).value("warmup_s", 0.0);
+        workload.db_warmup_operations = (*j_workload).value("warmup_operations", 0);
 
-        workload.upsert_proportion = (*j_workload).value("upsert_proportion", 0.0);
-        workload.update_proportion = (*j_workload).value("update_proportion", 0.0);
-        workload.remove_proportion = (*j_workload).value("remove_proportion", 0.0);
-        workload.read_proportion = (*j_workload).value("read_proportion", 0.0);
-        workload.read_modify_write_proportion = (*j_workload).value("read_modify_write_proportion", 0.0);
-        workload.batch_upsert_proportion = (*j_workload).value("batch_upsert_proportion", 0.0);
-        workload.batch_read_proportion = (*j_workload).value("batch_read_proportion", 0.0);
-        workload.bulk_load_proportion = (*j_workload).value("bulk_load_proportion", 0.0);
-        workload.range_select_proportion = (*j_workload).value("range_select_proportion", 0.0);
-        workload.scan_proportion = (*j_workload).value("scan_proportion", 0.0);
+        load_proportions(*j_workload, workload);
 
         workload.start_key = (*j_workload).value("start_key", 0);
         workload.key_dist = parse_distribution((*j_workload).value("key_dist", "uniform"));
@@ -135,6 +442,15 @@ bool load(fs::path const& path, workloads_t& workloads) {
             workloads.clear();
             return false;
         }
+        workload.hot_set_offset = (*j_workload).value("hot_set_offset", 0.0);
+        load_key_dist_parameters(*j_workload, workload);
+        workload.trace_path = (*j_workload).value("trace_path", "");
+        std::string replay_timing = (*j_workload).value("replay_timing", "fast");
+        if (replay_timing != "fast" && replay_timing != "original") {
+            workloads.clear();
+            return false;
+        }
+        workload.replay_original_timing = replay_timing == "original";
 
         workload.value_length = (*j_workload).value("value_length", 0);
         workload.value_length_dist = parse_distribution((*j_workload).value("value_length_dist", "const"));
@@ -142,9 +458,9 @@ bool load(fs::path const& path, workloads_t& workloads) {
             workloads.clear();
             return false;
         }
+        workload.value_compression_ratio = (*j_workload).value("value_compression_ratio", 1.0);
 
-        workload.batch_upsert_min_length = (*j_workload).value("batch_upsert_min_length", 0);
-        workload.batch_upsert_max_length = (*j_workload).value("batch_upsert_max_length", 0);
+        load_lengths(*j_workload, workload);
         workload.batch_upsert_length_dist =
             parse_distribution((*j_workload).value("batch_upsert_length_dist", "uniform"));
         if (workload.batch_upsert_length_dist == distribution_kind_t::unknown_k) {
@@ -152,24 +468,18 @@ bool load(fs::path const& path, workloads_t& workloads) {
             return false;
         }
 
-        workload.batch_read_min_length = (*j_workload).value("batch_read_min_length", 0);
-        workload.batch_read_max_length = (*j_workload).value("batch_read_max_length", 0);
         workload.batch_read_length_dist = parse_distribution((*j_workload).value("batch_read_length_dist", "uniform"));
         if (workload.batch_read_length_dist == distribution_kind_t::unknown_k) {
             workloads.clear();
             return false;
         }
 
-        workload.bulk_load_min_length = (*j_workload).value("bulk_load_min_length", 0);
-        workload.bulk_load_max_length = (*j_workload).value("bulk_load_max_length", 0);
         workload.bulk_load_length_dist = parse_distribution((*j_workload).value("bulk_load_length_dist", "uniform"));
         if (workload.bulk_load_length_dist == distribution_kind_t::unknown_k) {
             workloads.clear();
             return false;
         }
 
-        workload.range_select_min_length = (*j_workload).value("range_select_min_length", 0);
-        workload.range_select_max_length = (*j_workload).value("range_select_max_length", 0);
         workload.range_select_length_dist =
             parse_distribution((*j_workload).value("range_select_length_dist", "uniform"));
         if (workload.key_dist == distribution_kind_t::unknown_k) {
@@ -177,6 +487,24 @@ bool load(fs::path const& path, workloads_t& workloads) {
             return false;
         }
 
+        if ((*j_workload).contains("phases") && !load_phases((*j_workload)["phases"], workload)) {
+            workloads.clear();
+            return false;
+        }
+        // Note: Searches run the steps as phases, at rates of their own
+        if ((*j_workload).contains("slo") &&
+            (!workload.phases.empty() || workload.key_dist == distribution_kind_t::replay_k ||
+             !load_slo((*j_workload)["slo"], workload))) {
+            workloads.clear();
+            return false;
+        }
+        // Note: Groups can't have phases of their own
+        if ((*j_workload).contains("groups") &&
+            (!workload.phases.empty() || !load_groups((*j_workload)["groups"], workload))) {
+            workloads.clear();
+            return false;
+        }
+
         workloads.push_back(workload);
     }
 
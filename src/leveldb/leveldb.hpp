@@ -41,6 +41,13 @@ inline leveldb::Slice to_slice(value_spanc_t value) {
     return {reinterpret_cast<char const*>(value.data()), value.size()};
 }
 
+/*
+ * @brief Preallocated buffer for reads, as LevelDB can only read into `std::string`.
+ * Reusing it keeps the capacity, so reads don't allocate in steady state.
+ * Globals and especially `thread_local`s are a bad practice.
+ */
+thread_local std::string read_buffer;
+
 /**
  * @brief LevelDB wrapper for the UCSB benchmark.
  * It's the precursor of RocksDB by Facebook.
@@ -177,7 +184,7 @@ operation_result_t leveldb_t::upsert(key_t key, value_spanc_t value) {
 
 operation_result_t leveldb_t::update(key_t key, value_spanc_t value) {
 
-    std::string data;
+    std::string& data = read_buffer;
     leveldb::Status status = db_->Get(read_options_, to_slice(key), &data);
     if (status.IsNotFound())
         return {0, operation_status_t::not_found_k};
@@ -196,8 +203,8 @@ operation_result_t leveldb_t::remove(key_t key) {
 operation_result_t leveldb_t::read(key_t key, value_span_t value) const {
 
     // Unlike RocksDB, we can't read into some form fo a `PinnableSlice`,
-    // just `std::string`, causing heap allocations.
-    std::string data;
+    // just `std::string`, so we reuse one to avoid heap allocations.
+    std::string& data = read_buffer;
     leveldb::Status status = db_->Get(read_options_, to_slice(key), &data);
     if (status.IsNotFound())
         return {0, operation_status_t::not_found_k};
@@ -227,8 +234,8 @@ operation_result_t leveldb_t::batch_read(keys_spanc_t keys, values_span_t values
     // Note: imitation of batch read!
     size_t offset = 0;
     size_t found_cnt = 0;
+    std::string& data = read_buffer;
     for (auto key : keys) {
-        std::string data;
         leveldb::Status status = db_->Get(read_options_, to_slice(key), &data);
         if (status.ok()) {
             memcpy(values.data() + offset, data.data(), data.size());
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "src/core/types.hpp"
+#include "src/core/db.hpp"
+
+namespace ucsb::null {
+
+namespace fs = ucsb::fs;
+
+using key_t = ucsb::key_t;
+using keys_spanc_t = ucsb::keys_spanc_t;
+using value_t = ucsb::value_t;
+using value_span_t = ucsb::value_span_t;
+using value_spanc_t = ucsb::value_spanc_t;
+using values_span_t = ucsb::values_span_t;
+using values_spanc_t = ucsb::values_spanc_t;
+using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
+using operation_status_t = ucsb::operation_status_t;
+using operation_result_t = ucsb::operation_result_t;
+using db_hints_t = ucsb::db_hints_t;
+using transaction_t = ucsb::transaction_t;
+
+/**
+ * @brief A DB, that does nothing and reports every operation as successful.
+ * Benchmarking it measures the ceiling of the harness itself: generators,
+ * operation chooser, virtual dispatch and accounting.
+ */
+class null_t : public ucsb::db_t {
+  public:
+    inline null_t() = default;
+    ~null_t() = default;
+
+    void set_config(fs::path const& config_path,
+                    fs::path const& main_dir_path,
+                    std::vector<fs::path> const& storage_dir_paths,
+                    db_hints_t const& hints) override;
+    bool open(std::string& error) override;
+    void close() override;
+
+    std::string info() override;
+
+    operation_result_t upsert(key_t key, value_spanc_t value) override;
+    operation_result_t update(key_t key, value_spanc_t value) override;
+    operation_result_t remove(key_t key) override;
+    operation_result_t read(key_t key, value_span_t value) const override;
+
+    operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
+    operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
+
+    operation_result_t bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
+
+    operation_result_t range_select(key_t key, size_t length, values_span_t values) const override;
+    operation_result_t scan(key_t key, size_t length, value_span_t single_value) const override;
+
+    void flush() override;
+
+    size_t size_on_disk() const override;
+
+    std::unique_ptr<transaction_t> create_transaction() override;
+};
+
+void null_t::set_config([[maybe_unused]] fs::path const& config_path,
+                        [[maybe_unused]] fs::path const& main_dir_path,
+                        [[maybe_unused]] std::vector<fs::path> const& storage_dir_paths,
+                        [[maybe_unused]] db_hints_t const& hints) {
+}
+
+bool null_t::open([[maybe_unused]] std::string& error) { return true; }
+
+void null_t::close() {}
+
+std::string null_t::info() { return "harness ceiling"; }
+
+operation_result_t null_t::upsert(key_t, value_spanc_t) { return {1, operation_status_t::ok_k}; }
+
+operation_result_t null_t::update(key_t, value_spanc_t) { return {1, operation_status_t::ok_k}; }
+
+operation_result_t null_t::remove(key_t) { return {1, operation_status_t::ok_k}; }
+
+operation_result_t null_t::read(key_t, value_span_t) const { return {1, operation_status_t::ok_k}; }
+
+operation_result_t null_t::batch_upsert(keys_spanc_t keys, values_spanc_t, value_lengths_spanc_t) {
+    return {keys.size(), operation_status_t::ok_k};
+}
+
+operation_result_t null_t::batch_read(keys_spanc_t keys, values_span_t) const {
+    return {keys.size(), operation_status_t::ok_k};
+}
+
+operation_result_t null_t::bulk_load(keys_spanc_t keys, values_spanc_t, value_lengths_spanc_t) {
+    return {keys.size(), operation_status_t::ok_k};
+}
+
+operation_result_t null_t::range_select(key_t, size_t length, values_span_t) const {
+    return {length, operation_status_t::ok_k};
+}
+
+operation_result_t null_t::scan(key_t, size_t length, value_span_t) const {
+    return {length, operation_status_t::ok_k};
+}
+
+void null_t::flush() {}
+
+size_t null_t::size_on_disk() const { return 0; }
+
+std::unique_ptr<transaction_t> null_t::create_transaction() { return std::make_unique<null_t>(); }
+
+/**
+ * @brief A DB, that only copies values between the caller's buffers and
+ * its own, without storing anything. Compared to `null_t` it adds the
+ * minimal memory traffic any real engine has to pay for.
+ */
+class echo_t : public ucsb::db_t {
+  public:
+    inline echo_t() = default;
+    ~echo_t() = default;
+
+    void set_config(fs::path const& config_path,
+                    fs::path const& main_dir_path,
+                    std::vector<fs::path> const& storage_dir_paths,
+                    db_hints_t const& hints) override;
+    bool open(std::string& error) override;
+    void close() override;
+
+    std::string info() override;
+
+    operation_result_t upsert(key_t key, value_spanc_t value) override;
+    operation_result_t update(key_t key, value_spanc_t value) override;
+    operation_result_t remove(key_t key) override;
+    operation_result_t read(key_t key, value_span_t value) const override;
+
+    operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
+    operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
+
+    operation_result_t bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
+
+    operation_result_t range_select(key_t key, size_t length, values_span_t values) const override;
+    operation_result_t scan(key_t key, size_t length, value_span_t single_value) const override;
+
+    void flush() override;
+
+    size_t size_on_disk() const override;
+
+    std::unique_ptr<transaction_t> create_transaction() override;
+
+  private:
+    inline void write(value_spanc_t value);
+    inline size_t copy_value(value_span_t destination) const;
+
+    // Note: Read-only after `set_config`, so it can be shared by all threads
+    value_t value_;
+};
+
+void echo_t::set_config([[maybe_unused]] fs::path const& config_path,
+                        [[maybe_unused]] fs::path const& main_dir_path,
+                        [[maybe_unused]] std::vector<fs::path> const& storage_dir_paths,
+                        db_hints_t const& hints) {
+    value_ = value_t(std::max(hints.value_length, size_t(1)), std::byte('e'));
+}
+
+bool echo_t::open([[maybe_unused]] std::string& error) { return true; }
+
+void echo_t::close() {}
+
+std::string echo_t::info() { return "memcpy ceiling"; }
+
+operation_result_t echo_t::upsert(key_t, value_spanc_t value) {
+    write(value);
+    return {1, operation_status_t::ok_k};
+}
+
+operation_result_t echo_t::update(key_t, value_spanc_t value) {
+    write(value);
+    return {1, operation_status_t::ok_k};
+}
+
+operation_result_t echo_t::remove(key_t) { return {1, operation_status_t::ok_k}; }
+
+operation_result_t echo_t::read(key_t, value_span_t value) const {
+    copy_value(value);
+    return {1, operation_status_t::ok_k};
+}
+
+operation_result_t echo_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
+    size_t offset = 0;
+    for (size_t idx = 0; idx < keys.size(); ++idx) {
+        write(values.subspan(offset, sizes[idx]));
+        offset += sizes[idx];
+    }
+    return {keys.size(), operation_status_t::ok_k};
+}
+
+operation_result_t echo_t::batch_read(keys_spanc_t keys, values_span_t values) const {
+    size_t offset = 0;
+    for (size_t idx = 0; idx < keys.size(); ++idx)
+        offset += copy_value(values.subspan(offset));
+    return {keys.size(), operation_status_t::ok_k};
+}
+
+operation_result_t echo_t::bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
+    return batch_upsert(keys, values, sizes);
+}
+
+operation_result_t echo_t::range_select(key_t, size_t length, values_span_t values) const {
+    size_t offset = 0;
+    for (size_t idx = 0; idx < length; ++idx)
+        offset += copy_value(values.subspan(offset));
+    return {length, operation_status_t::ok_k};
+}
+
+operation_result_t echo_t::scan(key_t, size_t length, value_span_t single_value) const {
+    for (size_t idx = 0; idx < length; ++idx)
+        copy_value(single_value);
+    return {length, operation_status_t::ok_k};
+}
+
+void echo_t::flush() {}
+
+size_t echo_t::size_on_disk() const { return 0; }
+
+std::unique_ptr<transaction_t> echo_t::create_transaction() { return std::make_unique<echo_t>(*this); }
+
+inline void echo_t::write(value_spanc_t value) {
+    // Note: Every thread writes into its own sink to avoid false sharing
+    thread_local value_t sink;
+    if (sink.size() < value.size())
+        sink.resize(value.size());
+    memcpy(sink.data(), value.data(), value.size());
+}
+
+inline size_t echo_t::copy_value(value_span_t destination) const {
+    size_t length = std::min(destination.size(), value_.size());
+    memcpy(destination.data(), value_.data(), length);
+    return length;
+}
+
+} // namespace ucsb::null